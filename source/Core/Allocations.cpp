@@ -0,0 +1,110 @@
+#include "Core/Allocations.hpp"
+#include "Core/Parallel.hpp"
+
+#include <cstdlib>
+#include <new>
+
+#if defined(HAXAGON_TRACK_ALLOCS) || defined(HAXAGON_THREADS)
+#include <atomic>
+#endif
+
+namespace {
+#if defined(HAXAGON_TRACK_ALLOCS) || defined(HAXAGON_THREADS)
+	// Packs are loaded (and host tools work) on several threads
+	using Counter = std::atomic<size_t>;
+#else
+	using Counter = size_t;
+#endif
+
+	Counter allocationCount{0};
+
+#ifdef HAXAGON_TRACK_ALLOCS
+	// Every block carries its size in front of it so frees can be accounted for.
+	struct alignas(std::max_align_t) Header {
+		size_t size;
+	};
+
+	Counter allocationBytes{0};
+	Counter liveCount{0};
+	Counter liveBytes{0};
+	SuperHaxagon::AllocationHook allocationHook = nullptr;
+#endif
+
+	void* allocate(size_t size) {
+		allocationCount++;
+
+#ifdef HAXAGON_TRACK_ALLOCS
+		allocationBytes += size;
+		liveCount++;
+		liveBytes += size;
+		if (allocationHook) allocationHook(size);
+		auto* header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+		auto* ptr = header ? static_cast<void*>(header + 1) : nullptr;
+		if (header) header->size = size;
+#else
+		auto* ptr = std::malloc(size ? size : 1);
+#endif
+
+		if (!ptr) {
+#if __cpp_exceptions
+			throw std::bad_alloc();
+#else
+			std::abort();
+#endif
+		}
+
+		return ptr;
+	}
+
+	void deallocate(void* ptr) {
+#ifdef HAXAGON_TRACK_ALLOCS
+		if (!ptr) return;
+		auto* header = static_cast<Header*>(ptr) - 1;
+		liveCount--;
+		liveBytes -= header->size;
+		ptr = header;
+#endif
+
+		std::free(ptr);
+	}
+}
+
+namespace SuperHaxagon {
+	size_t getAllocationCount() {
+		return allocationCount;
+	}
+
+#ifdef HAXAGON_TRACK_ALLOCS
+	AllocationStats getAllocationStats() {
+		return {allocationCount, allocationBytes, liveCount, liveBytes};
+	}
+
+	void setAllocationHook(const AllocationHook hook) {
+		allocationHook = hook;
+	}
+#endif
+}
+
+void* operator new(const size_t size) {
+	return allocate(size);
+}
+
+void* operator new[](const size_t size) {
+	return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+	deallocate(ptr);
+}
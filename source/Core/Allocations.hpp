@@ -0,0 +1,35 @@
+#ifndef SUPER_HAXAGON_ALLOCATIONS_HPP
+#define SUPER_HAXAGON_ALLOCATIONS_HPP
+
+#include <cstddef>
+
+namespace SuperHaxagon {
+	/**
+	 * Gets the number of times operator new has been called since boot.
+	 * Counting is a single increment, so it is always enabled.
+	 */
+	size_t getAllocationCount();
+
+#ifdef HAXAGON_TRACK_ALLOCS
+	// Test and benchmark builds also keep track of sizes and frees
+
+	struct AllocationStats {
+		size_t count;     // Allocations since boot
+		size_t bytes;     // Bytes allocated since boot
+		size_t liveCount; // Allocations not yet freed
+		size_t liveBytes; // Bytes not yet freed
+	};
+
+	using AllocationHook = void (*)(size_t size);
+
+	AllocationStats getAllocationStats();
+
+	/**
+	 * Calls hook with the requested size on every allocation, or
+	 * stops calling it if hook is null. Handy as a breakpoint target.
+	 */
+	void setAllocationHook(AllocationHook hook);
+#endif
+}
+
+#endif //SUPER_HAXAGON_ALLOCATIONS_HPP
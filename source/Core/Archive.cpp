@@ -0,0 +1,152 @@
+#include "Core/Archive.hpp"
+
+#include "Core/MemoryStream.hpp"
+#include "Driver/Platform.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace SuperHaxagon {
+	const char* Archive::ARCHIVE_HEADER = "HXA1";
+
+	// Far more than any real index, but stops a broken header asking for gigabytes
+	static constexpr uint32_t MAX_TABLE = 1024 * 1024;
+
+	uint32_t Archive::hashName(const std::string_view name) {
+		uint32_t hash = 0x811C9DC5;
+		for (const auto c : name) hash = (hash ^ static_cast<uint8_t>(c)) * 0x01000193;
+		return hash;
+	}
+
+	void Archive::write(std::ostream& out, const std::vector<std::pair<std::string, std::vector<uint8_t>>>& files, const bool bigEndian) {
+		const auto swap = bigEndian != (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+		std::vector<uint8_t> bytes;
+		const auto set32 = [&](const size_t at, uint32_t value) {
+			if (swap) value = __builtin_bswap32(value);
+			std::memcpy(&bytes[at], &value, sizeof(value));
+		};
+
+		const auto align = [&]() {
+			while (bytes.size() % 4) bytes.push_back(0);
+		};
+
+		// By hash, then by name for hashes that collide
+		std::vector<const std::pair<std::string, std::vector<uint8_t>>*> sorted;
+		for (const auto& file : files) sorted.push_back(&file);
+		std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+			const auto hashA = hashName(a->first);
+			const auto hashB = hashName(b->first);
+			return hashA != hashB ? hashA < hashB : a->first < b->first;
+		});
+
+		bytes.resize(sizeof(ArchiveHeader) + sorted.size() * sizeof(ArchiveEntry));
+		std::vector<uint32_t> names;
+		for (const auto* file : sorted) {
+			names.push_back(static_cast<uint32_t>(bytes.size()));
+			bytes.insert(bytes.end(), file->first.begin(), file->first.end());
+			bytes.push_back(0);
+		}
+
+		align();
+		const auto data = static_cast<uint32_t>(bytes.size());
+		for (size_t i = 0; i < sorted.size(); i++) {
+			const auto& contents = sorted[i]->second;
+			const auto at = sizeof(ArchiveHeader) + i * sizeof(ArchiveEntry);
+			set32(at + offsetof(ArchiveEntry, hash), hashName(sorted[i]->first));
+			set32(at + offsetof(ArchiveEntry, name), names[i]);
+			set32(at + offsetof(ArchiveEntry, offset), static_cast<uint32_t>(bytes.size()));
+			set32(at + offsetof(ArchiveEntry, size), static_cast<uint32_t>(contents.size()));
+			bytes.insert(bytes.end(), contents.begin(), contents.end());
+			align();
+		}
+
+		std::memcpy(bytes.data(), ARCHIVE_HEADER, sizeof(ArchiveHeader::magic));
+		set32(offsetof(ArchiveHeader, order), ORDER_MARK);
+		set32(offsetof(ArchiveHeader, count), static_cast<uint32_t>(sorted.size()));
+		set32(offsetof(ArchiveHeader, data), data);
+		set32(offsetof(ArchiveHeader, size), static_cast<uint32_t>(bytes.size()));
+		out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	Archive::Archive(const uint8_t* data, const size_t size, const Platform& platform, const char* name) : _table(data) {
+		_loaded = validate(size, platform, name);
+	}
+
+	Archive::Archive(std::unique_ptr<std::istream> file, const Platform& platform, const char* name) : _file(std::move(file)) {
+		_tableStorage.resize(sizeof(ArchiveHeader));
+		_table = _tableStorage.data();
+		if (!_file || !_file->read(reinterpret_cast<char*>(_tableStorage.data()), sizeof(ArchiveHeader))) {
+			platform.message(Dbg::WARN, "archive", std::string(name) + ": cannot be read");
+			return;
+		}
+
+		// Only read the rest of the index if the header looks right, validate says what's wrong otherwise
+		const auto& header = getHeader();
+		if (std::memcmp(header.magic, ARCHIVE_HEADER, sizeof(header.magic)) == 0 && header.order == ORDER_MARK && header.data <= MAX_TABLE) {
+			const auto table = std::max<size_t>(header.data, sizeof(ArchiveHeader));
+			_tableStorage.resize(table);
+			_table = _tableStorage.data();
+			_file->read(reinterpret_cast<char*>(_tableStorage.data() + sizeof(ArchiveHeader)), static_cast<std::streamsize>(table - sizeof(ArchiveHeader)));
+			if (!*_file) {
+				platform.message(Dbg::WARN, "archive", std::string(name) + ": index cannot be read");
+				return;
+			}
+		}
+
+		_loaded = validate(_tableStorage.size(), platform, name);
+	}
+
+	bool Archive::validate(const size_t tableSize, const Platform& platform, const char* name) const {
+		const auto fail = [&](const char* problem) {
+			platform.message(Dbg::WARN, "archive", std::string(name) + ": " + problem);
+			return false;
+		};
+
+		if (tableSize < sizeof(ArchiveHeader) || std::memcmp(_table, ARCHIVE_HEADER, sizeof(ArchiveHeader::magic)) != 0) return fail("not an asset archive");
+
+		const auto& header = getHeader();
+		if (header.order == __builtin_bswap32(ORDER_MARK)) return fail("archive was built for the other byte order");
+		if (header.order != ORDER_MARK) return fail("byte order mark invalid");
+		if (header.data > tableSize || header.data > header.size || header.data < sizeof(ArchiveHeader)) return fail("index out of bounds");
+		if (!_file && header.size > tableSize) return fail("archive is cut short");
+		if (header.count > (header.data - sizeof(ArchiveHeader)) / sizeof(ArchiveEntry)) return fail("index out of bounds");
+
+		const auto* entries = getEntries();
+		for (uint32_t i = 0; i < header.count; i++) {
+			const auto& entry = entries[i];
+			if (entry.name >= header.data || !std::memchr(_table + entry.name, 0, header.data - entry.name)) return fail("file name out of bounds");
+			if (entry.offset > header.size || entry.size > header.size - entry.offset) return fail("file out of bounds");
+			if (i > 0 && entries[i - 1].hash > entry.hash) return fail("index is not sorted");
+		}
+
+		return true;
+	}
+
+	const ArchiveEntry* Archive::find(const std::string_view path) const {
+		if (!_loaded) return nullptr;
+
+		const auto hash = hashName(path);
+		const auto* begin = getEntries();
+		const auto* end = begin + getHeader().count;
+		for (auto* entry = std::lower_bound(begin, end, hash, [](const ArchiveEntry& e, const uint32_t h) {return e.hash < h;}); entry != end && entry->hash == hash; ++entry) {
+			if (path == reinterpret_cast<const char*>(_table + entry->name)) return entry;
+		}
+
+		return nullptr;
+	}
+
+	std::unique_ptr<std::istream> Archive::open(const std::string_view path) const {
+		const auto* entry = find(path);
+		if (!entry) return nullptr;
+		if (!_file) return std::make_unique<MemoryStream>(_table + entry->offset, entry->size);
+
+		auto bytes = std::make_shared<std::vector<uint8_t>>(entry->size);
+		_file->clear();
+		_file->seekg(entry->offset);
+		_file->read(reinterpret_cast<char*>(bytes->data()), static_cast<std::streamsize>(bytes->size()));
+		if (!*_file) return nullptr;
+
+		const auto* data = bytes->data();
+		return std::make_unique<MemoryStream>(data, entry->size, std::move(bytes));
+	}
+}
@@ -0,0 +1,97 @@
+#ifndef SUPER_HAXAGON_ARCHIVE_HPP
+#define SUPER_HAXAGON_ARCHIVE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace SuperHaxagon {
+	class Platform;
+
+	// An asset archive is a set of files in one blob, built on the host by
+	// haxar. The index comes first, sorted by name hash, then the names, then
+	// the files. Everything is in the byte order of the machine that reads it
+	// and 4 byte aligned, offsets are from the start of the archive.
+
+	struct ArchiveHeader {
+		char magic[4];     // "HXA1"
+		uint32_t order;    // Archive::ORDER_MARK as written by haxar
+		uint32_t count;    // Entries in the index, which follows this header
+		uint32_t data;     // Start of the files, everything before is index and names
+		uint32_t size;     // Of the whole archive
+	};
+
+	struct ArchiveEntry {
+		uint32_t hash;     // Archive::hashName of the name
+		uint32_t name;     // -> null terminated path, like "/bgm/screenSaver.txt"
+		uint32_t offset;   // -> the file's bytes
+		uint32_t size;
+	};
+
+	class Archive {
+	public:
+		static const char* ARCHIVE_HEADER;
+		static constexpr uint32_t ORDER_MARK = 0x01020304;
+
+		/**
+		 * FNV-1a over the bytes of the name, the same on every machine
+		 */
+		static uint32_t hashName(std::string_view name);
+
+		/**
+		 * Writes files (path and contents) as an archive for a machine with the given byte order
+		 */
+		static void write(std::ostream& out, const std::vector<std::pair<std::string, std::vector<uint8_t>>>& files, bool bigEndian);
+
+		/**
+		 * An archive that is already in memory, compiled in or read in one go.
+		 * Files are opened as streams straight over it, so it must outlive them.
+		 */
+		Archive(const uint8_t* data, size_t size, const Platform& platform, const char* name);
+
+		/**
+		 * An archive that stays in a file. Only the index is read now, then
+		 * opening a file is one seek and one read.
+		 */
+		Archive(std::unique_ptr<std::istream> file, const Platform& platform, const char* name);
+		Archive(Archive&) = delete;
+
+		bool isLoaded() const {return _loaded;}
+		size_t getCount() const {return _loaded ? getHeader().count : 0;}
+
+		/**
+		 * The entry for a path, or null if the archive doesn't have it
+		 */
+		const ArchiveEntry* find(std::string_view path) const;
+
+		/**
+		 * Where a file's bytes are, for an archive in memory. Null for one in a file.
+		 */
+		const uint8_t* getBytes(const ArchiveEntry& entry) const {return _file ? nullptr : _table + entry.offset;}
+
+		/**
+		 * A stream of a file in the archive, or null if it doesn't have it.
+		 * Not thread safe for an archive in a file, they share the file.
+		 */
+		std::unique_ptr<std::istream> open(std::string_view path) const;
+
+	private:
+		const ArchiveHeader& getHeader() const {return *reinterpret_cast<const ArchiveHeader*>(_table);}
+		const ArchiveEntry* getEntries() const {return reinterpret_cast<const ArchiveEntry*>(_table + sizeof(ArchiveHeader));}
+		bool validate(size_t tableSize, const Platform& platform, const char* name) const;
+
+		// The header, index and names. In memory that's the whole archive.
+		const uint8_t* _table = nullptr;
+		std::vector<uint8_t> _tableStorage;
+		std::unique_ptr<std::istream> _file;
+		bool _loaded = false;
+	};
+}
+
+#endif //SUPER_HAXAGON_ARCHIVE_HPP
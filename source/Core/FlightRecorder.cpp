@@ -0,0 +1,84 @@
+#include "Core/FlightRecorder.hpp"
+
+#include "Core/Allocations.hpp"
+#include "Core/Game.hpp"
+#include "Core/Log.hpp"
+#include "Driver/Platform.hpp"
+
+#include <cstdio>
+
+namespace SuperHaxagon {
+	static const char* PHASE_NAMES[PHASE_LAST] = {"aud", "upd", "trn", "top", "bot", "prs"};
+
+	FlightRecorder::FlightRecorder(Platform& platform) : _platform(platform), _start(getCurrentTime()) {}
+
+	void FlightRecorder::beginFrame() {
+		auto& frame = _frames[_head];
+		frame.phases.fill(0);
+		_frameStart = getCurrentTime();
+		_phaseStart = _frameStart;
+		_allocations = getAllocationCount();
+	}
+
+	void FlightRecorder::phase(const Phase phase) {
+		const auto now = getCurrentTime();
+		_frames[_head].phases[static_cast<int>(phase)] += static_cast<float>((now - _phaseStart) * 1000.0);
+		_phaseStart = now;
+	}
+
+	void FlightRecorder::endFrame(const char* state, const size_t patterns) {
+		auto& frame = _frames[_head];
+		frame.total = static_cast<float>((getCurrentTime() - _frameStart) * 1000.0);
+		frame.state = state;
+		frame.allocations = static_cast<uint32_t>(getAllocationCount() - _allocations);
+		frame.patterns = static_cast<uint16_t>(patterns);
+
+		if (_firstFrame == 0) {
+			_firstFrame = getTimeSinceStart();
+			log<Dbg::INFO>(_platform, "recorder", [&] {
+				char line[64];
+				snprintf(line, sizeof(line), "first frame %.2fms after start", _firstFrame);
+				return std::string(line);
+			});
+		}
+
+		_head = (_head + 1) % FRAMES;
+		if (_count < FRAMES) _count++;
+		if (_cooldown > 0) _cooldown--;
+
+		// Only dump once per full ring so a burst of slow frames
+		// doesn't turn into a burst of (even slower) log output.
+		if (_budget > 0 && frame.total > _budget && _cooldown == 0) {
+			_cooldown = FRAMES;
+			char line[64];
+			snprintf(line, sizeof(line), "frame took %.2fms (budget %.2fms)", frame.total, _budget);
+			_platform.message(Dbg::WARN, "recorder", line);
+			dump();
+		}
+	}
+
+	void FlightRecorder::dump() const {
+		char line[160];
+		for (auto age = _count; age > 0; age--) {
+			const auto& frame = getFrame(age - 1);
+			auto length = snprintf(line, sizeof(line), "-%03u %-10s %6.2fms p:%2u a:%3u |",
+				static_cast<unsigned>(age - 1), frame.state ? frame.state : "?", frame.total,
+				static_cast<unsigned>(frame.patterns), static_cast<unsigned>(frame.allocations));
+
+			for (auto i = PHASE_FIRST; i != PHASE_LAST && length > 0 && static_cast<size_t>(length) < sizeof(line); i++) {
+				length += snprintf(line + length, sizeof(line) - length, " %s %5.2f", PHASE_NAMES[i], frame.phases[i]);
+			}
+
+			_platform.message(Dbg::INFO, "recorder", line);
+		}
+	}
+
+	float FlightRecorder::getTimeSinceStart() const {
+		return static_cast<float>((getCurrentTime() - _start) * 1000.0);
+	}
+
+	const FrameRecord& FlightRecorder::getFrame(const size_t age) const {
+		// Age 0 is the most recently finished frame
+		return _frames[(_head + FRAMES - 1 - age % FRAMES) % FRAMES];
+	}
+}
@@ -0,0 +1,104 @@
+#ifndef SUPER_HAXAGON_FLIGHT_RECORDER_HPP
+#define SUPER_HAXAGON_FLIGHT_RECORDER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace SuperHaxagon {
+	class Platform;
+
+	enum class Phase {
+		AUDIO = 0,
+		UPDATE,
+		TRANSITION,
+		DRAW_TOP,
+		DRAW_BOT,
+		PRESENT,
+		LAST // Unused, but used for iteration
+	};
+
+	static constexpr int PHASE_FIRST = static_cast<int>(Phase::AUDIO);
+	static constexpr int PHASE_LAST = static_cast<int>(Phase::LAST);
+
+	struct FrameRecord {
+		std::array<float, PHASE_LAST> phases; // Milliseconds spent in each phase
+		float total;                          // Milliseconds spent on the whole frame
+		const char* state;                    // Name of the state that finished the frame
+		uint32_t allocations;                 // Heap allocations made during the frame
+		uint16_t patterns;                    // Live patterns at the end of the frame
+	};
+
+	/**
+	 * Keeps the timing of the last few seconds of frames in a fixed ring buffer.
+	 * When a frame runs over budget the whole ring is dumped through
+	 * Platform::message so the frames leading up to the spike can be inspected.
+	 * Recording never allocates, so it is safe to leave on in release builds.
+	 */
+	class FlightRecorder {
+	public:
+		static constexpr size_t FRAMES = 180; // Three seconds at 60 FPS
+		static constexpr float DEFAULT_BUDGET = 1000.0f / 60.0f * 1.5f;
+
+		explicit FlightRecorder(Platform& platform);
+		FlightRecorder(FlightRecorder&) = delete;
+
+		/**
+		 * Sets the frame time in milliseconds that triggers a dump.
+		 * A budget of zero or less disables dumping entirely.
+		 */
+		void setBudget(float budget) {_budget = budget;}
+		float getBudget() const {return _budget;}
+
+		/**
+		 * Starts timing a new frame. Call after the platform has finished waiting for vsync.
+		 */
+		void beginFrame();
+
+		/**
+		 * Charges the time since the last call (or beginFrame) to a phase.
+		 */
+		void phase(Phase phase);
+
+		/**
+		 * Finishes the frame, storing it in the ring and dumping if it ran over budget.
+		 */
+		void endFrame(const char* state, size_t patterns);
+
+		/**
+		 * Writes every frame in the ring, oldest first, to the platform's log.
+		 */
+		void dump() const;
+
+		const FrameRecord& getFrame(size_t age) const;
+		size_t getFrameCount() const {return _count;}
+
+		/**
+		 * Milliseconds from the recorder being created (with the game) to the
+		 * end of the first frame, which is how long the screen stays blank at boot.
+		 * Zero until the first frame is done.
+		 */
+		float getTimeToFirstFrame() const {return _firstFrame;}
+
+		/**
+		 * Milliseconds since the recorder was created
+		 */
+		float getTimeSinceStart() const;
+
+	private:
+		Platform& _platform;
+		std::array<FrameRecord, FRAMES> _frames{};
+
+		size_t _head = 0;
+		size_t _count = 0;
+		size_t _cooldown = 0;
+		size_t _allocations = 0;
+		double _start = 0;
+		double _frameStart = 0;
+		double _phaseStart = 0;
+		float _budget = DEFAULT_BUDGET;
+		float _firstFrame = 0;
+	};
+}
+
+#endif //SUPER_HAXAGON_FLIGHT_RECORDER_HPP
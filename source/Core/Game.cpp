@@ -1,6 +1,10 @@
 #include "Core/Game.hpp"
 
+#include "Core/FlightRecorder.hpp"
+#include "Core/Log.hpp"
+#include "Core/Memory.hpp"
 #include "Core/Metadata.hpp"
+#include "Core/ScoreDb.hpp"
 #include "Core/Twist.hpp"
 #include "Driver/Font.hpp"
 #include "Driver/Sound.hpp"
@@ -8,44 +12,54 @@
 #include "Driver/Platform.hpp"
 #include "Factories/LevelFactory.hpp"
 #include "Factories/PatternFactory.hpp"
+#include "Factories/PatternLibrary.hpp"
+#include "Objects/Level.hpp"
 #include "States/Load.hpp"
 
-#include <libdragon.h>
-
+#include <algorithm>
 #include <cmath>
 
 namespace SuperHaxagon {
+	static constexpr int FONT_SMALL = 16;
+	static constexpr int FONT_LARGE = 32;
+	static constexpr size_t FONT_COUNT = 2;
+
+	// Loaded after the fonts, in the order they're first played. The last
+	// two aren't played until a level ends, so they wait until the menu is up.
+	static const std::pair<SoundEffect, const char*> SOUNDS[] = {
+		{SoundEffect::HEXAGON, "/sound/hexagon"},
+		{SoundEffect::SELECT, "/sound/select"},
+		{SoundEffect::BEGIN, "/sound/begin"},
+		{SoundEffect::LEVEL_UP, "/sound/level"},
+		{SoundEffect::OVER, "/sound/over"},
+		{SoundEffect::WONDERFUL, "/sound/wonderful"},
+	};
+
+	static constexpr size_t ASSET_COUNT = FONT_COUNT + sizeof(SOUNDS) / sizeof(SOUNDS[0]);
+	static constexpr size_t MENU_ASSET_COUNT = ASSET_COUNT - 2;
 
 	Game::Game(Platform& platform) : _platform(platform) {
-		// Audio loading
-		const std::vector<std::pair<SoundEffect, std::string>> sounds{
-			{SoundEffect::BEGIN, "/sound/begin"},
-			{SoundEffect::HEXAGON, "/sound/hexagon"},
-			{SoundEffect::OVER, "/sound/over"},
-			{SoundEffect::SELECT, "/sound/select"},
-			{SoundEffect::LEVEL_UP, "/sound/level"},
-			{SoundEffect::WONDERFUL, "/sound/wonderful"},
-		};
-
-		for (const auto& sound : sounds) {
-			_soundEffects.emplace_back(sound.first, platform.loadSound(sound.second));
-		}
+		// First, so that boot time includes loading everything below
+		_recorder = std::make_unique<FlightRecorder>(platform);
 
-		_fontSmall = platform.loadFont(16);
-		_fontLarge = platform.loadFont(32);
+		// Fonts and sounds aren't loaded here, the load screen doesn't need them. See loadNextAsset.
 		_twister = platform.getTwister();
+		_patternPool = std::make_shared<PatternPool>();
+		_scores = std::make_unique<ScoreDb>(platform);
 	}
 
 	Game::~Game() {
 		// Stop and unload music
 		_bgm = nullptr;
-		_platform.message(SuperHaxagon::Dbg::INFO, "game", "shutdown ok");
+		log<Dbg::INFO>(_platform, "game", [] {return "shutdown ok";});
 	}
 
 	void Game::run() {
 		_state = std::make_unique<Load>(*this);
 		_state->enter();
 		while(_running && _platform.loop()) {
+			_recorder->beginFrame();
+
 			// The original game was built with a 3DS in mind, so when
 			// drawing we have to scale the game to however many times larger the viewport is.
 			const auto scale = getScreenDimMin() / 240.0f;
@@ -56,12 +70,14 @@ namespace SuperHaxagon {
 			// when the process is suspended (for example, the 3ds on the home menu)
 			dilation = dilation > 5.0f ? 5.0f : (dilation < 0.05f ? 0.05f : dilation);
 
-			updateRumble(display_get_delta_time());
+			updateRumble(dilation / 60.0f);
 
 			// For platforms that need it, tick the BGM.
 			if (_bgm) _bgm->update();
+			_recorder->phase(Phase::AUDIO);
 
 			auto next = _state->update(dilation);
+			_recorder->phase(Phase::UPDATE);
 			if (!_running) break;
 			while (next) {
 				_state->exit();
@@ -70,27 +86,56 @@ namespace SuperHaxagon {
 				next = _state->update(dilation);
 			}
 
+			_recorder->phase(Phase::TRANSITION);
+
 			_platform.screenBegin();
 			_state->drawTop(scale);
+			_recorder->phase(Phase::DRAW_TOP);
 			_platform.screenSwap();
 			_state->drawBot(scale);
+			_recorder->phase(Phase::DRAW_BOT);
 			_platform.screenFinalize();
+			_recorder->phase(Phase::PRESENT);
+
+			const auto* level = _state->getLevel();
+			_recorder->endFrame(_state->getName(), level ? level->getPatterns().size() : 0);
 		}
+
+		// Score blocks the game over and menu didn't get to yet, nothing is lost by quitting
+		_scores->save();
 	}
 
 	void Game::addLevel(std::unique_ptr<LevelFactory> level) {
 		_levels.emplace_back(std::move(level));
 	}
 
+	bool Game::loadPatterns(LevelFactory& level) {
+		const auto found = std::find(_resident.begin(), _resident.end(), &level);
+		if (found != _resident.end()) _resident.erase(found);
+		if (!level.loadPatterns(_platform)) {
+			_platform.message(Dbg::WARN, "game", "could not load the patterns for " + level.getName());
+			return false;
+		}
+
+		// Levels that are fully in memory (like HAX2 packs) are never evicted
+		if (!level.isOnDemand()) return true;
+		_resident.push_back(&level);
+
+		while (_resident.size() > 1 && Memory::getStats(MemTag::PATTERNS).current > PATTERN_BUDGET) {
+			_resident.front()->unloadPatterns();
+			_resident.erase(_resident.begin());
+		}
+
+		return true;
+	}
+
 	void Game::drawRect(const Color color, const Point position, const Point size) const {
-		const std::vector<Point> points{
-			{position.x, position.y + size.y},
-			{position.x + size.x, position.y + size.y},
-			{position.x + size.x, position.y},
-			{position.x, position.y},
-		};
-
-		_platform.drawPoly(color, points);
+		_quad.resize(4);
+		_quad[0] = {position.x, position.y + size.y};
+		_quad[1] = {position.x + size.x, position.y + size.y};
+		_quad[2] = {position.x + size.x, position.y};
+		_quad[3] = {position.x, position.y};
+		_platform.drawPoly(color, _quad);
 	}
 
 	void Game::drawBackground(const Color& color1, const Color& color2, const Point& focus, const float multiplier, const float rotation, const float sides) const {
@@ -104,7 +149,7 @@ namespace SuperHaxagon {
 		drawRect(color1, position, size);
 
 		//This draws the main background.
-		std::vector<Point> edges;
+		auto& edges = _edges;
 		edges.resize(exactSides);
 
 		for(size_t i = 0; i < exactSides; i++) {
@@ -112,7 +157,7 @@ namespace SuperHaxagon {
 			edges[i].y = multiplier * maxRenderDistance * sin(rotation + static_cast<float>(i) * TAU / sides + PI) + focus.y;
 		}
 
-		std::vector<Point> triangle;
+		auto& triangle = _triangle;
 		triangle.resize(3);
 
 		//if the sides is odd we need to "make up a color" to put in the gap between the last and first color
@@ -137,7 +182,7 @@ namespace SuperHaxagon {
 	void Game::drawRegular(const Color& color, const Point& focus, const float height, const float rotation, const float sides) const {
 		const auto exactSides = static_cast<size_t>(std::ceil(sides));
 
-		std::vector<Point> edges;
+		auto& edges = _edges;
 		edges.resize(exactSides);
 
 		// Calculate the triangle backwards so it overlaps correctly.
@@ -152,7 +197,7 @@ namespace SuperHaxagon {
 
 	void Game::drawCursor(const Color& color, const Point& focus, const float cursor, const float rotation, const float offset, const float scale) const {
 		// Note: A cursor and rotation of zero points to the left
-		std::vector<Point> triangle;
+		auto& triangle = _triangle;
 		triangle.resize(3);
 		triangle[0] = {offset * scale, -SCALE_HUMAN_WIDTH/2 * scale};
 		triangle[1] = {offset * scale, SCALE_HUMAN_WIDTH/2 * scale};
@@ -167,7 +212,7 @@ namespace SuperHaxagon {
 		_platform.drawPoly(color, triangle);
 	}
 
-	void Game::drawPatterns(const Color& color, const Point& focus, const std::deque<Pattern>& patterns, const float rotation, const float sides, const float offset, const float scale) const {
+	void Game::drawPatterns(const Color& color, const Point& focus, const std::vector<Pattern>& patterns, const float rotation, const float sides, const float offset, const float scale) const {
 		for(const auto& pattern : patterns) {
 			for(const auto& wall : pattern.getWalls()) {
 				drawWalls(color, focus, wall, rotation, sides, offset, scale);
@@ -179,10 +224,11 @@ namespace SuperHaxagon {
 		const auto distance = wall.getDistance() + offset;
 		if(distance + wall.getHeight() < SCALE_HEX_LENGTH) return; //TOO_CLOSE;
 		if(static_cast<float>(wall.getSide()) >= sides) return; //NOT_IN_RANGE
-		auto trap = wall.calcPoints(focus, rotation, sides, offset, scale);
+		const auto trap = wall.calcPoints(focus, rotation, sides, offset, scale);
 
-		skew(trap);
-		_platform.drawPoly(color, trap);
+		_quad.assign(trap.begin(), trap.end());
+		skew(_quad);
+		_platform.drawPoly(color, _quad);
 	}
 
 	Point Game::getScreenCenter() const {
@@ -206,14 +252,46 @@ namespace SuperHaxagon {
 		}
 	}
 
-	Font& Game::getFontSmall() const {
+	Font& Game::getFontSmall() {
+		// Normally loadNextAsset got to it already, but drawing can't wait
+		if (!_fontSmall) _fontSmall = loadFont(FONT_SMALL);
 		return *_fontSmall;
 	}
-	
-	Font& Game::getFontLarge() const {
+
+	Font& Game::getFontLarge() {
+		if (!_fontLarge) _fontLarge = loadFont(FONT_LARGE);
 		return *_fontLarge;
 	}
 
+	bool Game::loadNextAsset(const bool menuOnly) {
+		if (_nextAsset == (menuOnly ? MENU_ASSET_COUNT : ASSET_COUNT)) return false;
+
+		const auto next = _nextAsset++;
+		if (next == 0) {
+			getFontSmall();
+		} else if (next == 1) {
+			getFontLarge();
+		} else {
+			const auto& sound = SOUNDS[next - FONT_COUNT];
+			Memory::Scope scope(MemTag::SOUNDS);
+			_soundEffects.emplace_back(sound.first, _platform.loadSound(sound.second));
+			scope.finish();
+		}
+
+		return true;
+	}
+
+	void Game::stepScores() const {
+		_scores->step();
+	}
+
+	std::unique_ptr<Font> Game::loadFont(const int size) const {
+		Memory::Scope scope(MemTag::FONTS);
+		auto font = _platform.loadFont(size);
+		scope.finish();
+		return font;
+	}
+
 	float Game::getScreenDimMax() const {
 		const auto size = _platform.getScreenDim();
 		return std::max(size.x, size.y);
@@ -228,10 +306,20 @@ namespace SuperHaxagon {
 		const auto base = "/bgm" + music;
 
 		if (loadMetadata) {
-			_bgmMetadata = std::make_unique<Metadata>(_platform.openFile(base + ".txt", location));
+			_bgmMetadata = nullptr;
+			Memory::release(MemTag::METADATA, _bgmMetadataBytes);
+			Memory::Scope scope(MemTag::METADATA);
+			const auto file = Metadata::map(_platform, base, location);
+			_bgmMetadata = std::make_unique<Metadata>(file.data, file.size);
+			_bgmMetadataBytes = scope.finish();
 		}
-		
+
+		// Free the old track first so both are never resident at once
+		_bgm = nullptr;
+		Memory::release(MemTag::MUSIC, _bgmBytes);
+		Memory::Scope scope(MemTag::MUSIC);
 		_bgm = _platform.loadMusic(base, location);
+		_bgmBytes = scope.finish();
 
 		if (_bgm) {
 			_bgm->setLoop(loop);
@@ -240,6 +328,7 @@ namespace SuperHaxagon {
 	}
 
 	void Game::playEffect(SoundEffect effect) const {
+		// A sound that isn't loaded yet (or failed to) is skipped
 		for (auto& soundEffect : _soundEffects) {
 			if (effect == soundEffect.first && soundEffect.second) {
 				soundEffect.second->play();
@@ -248,18 +337,3 @@ namespace SuperHaxagon {
 	}
 
 }
-
-float rumbleTime = 0;
-
-double getCurrentTime() {
-	double ticks = timer_ticks();
-	return TICKS_TO_MS(ticks) / 1000.0f;
-}
-
-void addRumble(double time){
-	rumbleTime = getCurrentTime() + time;
-}
-
-void updateRumble(double dt){
-	joypad_set_rumble_active(JOYPAD_PORT_1, rumbleTime > getCurrentTime());
-}
\ No newline at end of file
@@ -1,7 +1,6 @@
 #ifndef SUPER_HAXAGON_GAME_HPP
 #define SUPER_HAXAGON_GAME_HPP
 
-#include <deque>
 #include <memory>
 #include <vector>
 #include <string>
@@ -11,8 +10,11 @@ namespace SuperHaxagon {
 	struct Point;
 	struct Color;
 	class LevelFactory;
+	class FlightRecorder;
 	class State;
 	class Pattern;
+	class PatternPool;
+	class ScoreDb;
 	class Wall;
 	class Platform;
 	class Twist;
@@ -25,6 +27,9 @@ namespace SuperHaxagon {
 
 	class Game {
 	public:
+		// Patterns read on demand are evicted, oldest played first, past this
+		static constexpr size_t PATTERN_BUDGET = 512 * 1024;
+
 		explicit Game(Platform& platform);
 		Game(const Game&) = delete;
 		~Game();
@@ -33,9 +38,26 @@ namespace SuperHaxagon {
 
 		Platform& getPlatform() const {return _platform;}
 		Twist& getTwister() const {return *_twister;}
+		FlightRecorder& getRecorder() const {return *_recorder;}
 		Metadata* getBGMMetadata() const {return _bgmMetadata.get();}
-		Font& getFontSmall() const;
-		Font& getFontLarge() const;
+		const std::shared_ptr<PatternPool>& getPatternPool() const {return _patternPool;}
+		ScoreDb& getScores() const {return *_scores;}
+		Font& getFontSmall();
+		Font& getFontLarge();
+
+		/**
+		 * Loads the next font or sound effect, in the order they're first needed.
+		 * Returns false once everything is loaded, or with menuOnly, once the menu
+		 * and levels have what they need. Fonts are also loaded the first time
+		 * they're asked for, and sounds that aren't loaded yet don't play.
+		 */
+		bool loadNextAsset(bool menuOnly = false);
+
+		/**
+		 * Writes one score block that changed, if there is one. The states
+		 * that aren't playing a level call it every frame until all are written.
+		 */
+		void stepScores() const;
 		float getScreenDimMax() const;
 		float getScreenDimMin() const;
 
@@ -57,6 +79,12 @@ namespace SuperHaxagon {
 		 */
 		void addLevel(std::unique_ptr<LevelFactory> level);
 
+		/**
+		 * Makes sure a level's patterns are in memory before it's played,
+		 * evicting the patterns of other levels if over PATTERN_BUDGET.
+		 */
+		bool loadPatterns(LevelFactory& level);
+
 		/**
 		 * Draws a rectangle at position with the size of size.
 		 * Position is the top left.
@@ -83,7 +111,7 @@ namespace SuperHaxagon {
 		 * Completely draws all patterns in a live level. Can also be used to create
 		 * an "Explosion" effect if you use "offset". (for game overs)
 		 */
-		void drawPatterns(const Color& color, const Point& focus, const std::deque<Pattern>& patterns, float rotation, float sides, float offset, float scale) const;
+		void drawPatterns(const Color& color, const Point& focus, const std::vector<Pattern>& patterns, float rotation, float sides, float offset, float scale) const;
 
 		/**
 		 * Draws a single moving wall based on a live wall, a color, some rotational value, and the total
@@ -107,25 +135,48 @@ namespace SuperHaxagon {
 		void skew(std::vector<Point>& skew) const;
 
 	private:
+		std::unique_ptr<Font> loadFont(int size) const;
+
 		Platform& _platform;
 
 		std::unique_ptr<Font> _fontSmall;
 		std::unique_ptr<Font> _fontLarge;
 		std::unique_ptr<Music> _bgm;
 		std::vector<std::pair<SoundEffect, std::unique_ptr<Sound>>> _soundEffects;
+		size_t _nextAsset = 0;
 		std::vector<std::unique_ptr<LevelFactory>> _levels;
 
+		// On demand levels with patterns in memory, least recently played first
+		std::vector<LevelFactory*> _resident;
+
+		// Shared by every pack so identical patterns are only loaded once
+		std::shared_ptr<PatternPool> _patternPool;
+
+		std::unique_ptr<ScoreDb> _scores;
 		std::unique_ptr<Twist> _twister;
 		std::unique_ptr<State> _state;
+		std::unique_ptr<FlightRecorder> _recorder;
 
 		std::unique_ptr<Metadata> _bgmMetadata;
 
+		// Bytes charged to memory accounting for the current track
+		size_t _bgmBytes = 0;
+		size_t _bgmMetadataBytes = 0;
+
+		// Scratch geometry reused by the draw functions so that drawing
+		// a frame doesn't allocate. Platform::drawPoly takes a vector.
+		mutable std::vector<Point> _edges;
+		mutable std::vector<Point> _triangle;
+		mutable std::vector<Point> _quad;
+
 		bool _running = true;
 		bool _shadowAuto = false;
 		float _skew = 0.0;
 	};
 }
 
+// Implemented by each platform driver
+
 double getCurrentTime();
 
 void addRumble(double time);
@@ -0,0 +1,175 @@
+#include "Core/LevelCache.hpp"
+
+#include "Core/Log.hpp"
+#include "Core/Lz.hpp"
+#include "Core/Pack.hpp"
+#include "Core/Reader.hpp"
+#include "Core/Structs.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+#include "States/Load.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+namespace SuperHaxagon {
+	const char* LevelCache::CACHE_HEADER = "HXC1";
+	const char* LevelCache::CACHE_DIRECTORY = "/cache/";
+	const char* LevelCache::MANIFEST_HEADER = "HXM1";
+	const char* LevelCache::MANIFEST = "/cache/packs.hxm";
+
+	// Written in front of the compiled pack, which starts right after it
+	// so that it's still 4 byte aligned when it's read back.
+	struct CacheEntry {
+		char magic[4];     // "HXC1"
+		uint32_t version;
+		uint64_t size;     // Of the pack it was compiled from
+		int64_t modified;
+		uint64_t hash;     // hashBytes of the pack it was compiled from
+	};
+
+	// Followed by a location byte, a length byte and the path of every pack
+	struct ManifestHeader {
+		char magic[4];     // "HXM1"
+		uint32_t count;
+		int64_t modified;  // Of the directory the packs were found in
+	};
+
+	LevelCache::LevelCache(Platform& platform) : _platform(platform) {}
+
+	FileView LevelCache::find(const std::string& partial, const Location location) const {
+		FileStamp stamp{};
+		if (!_platform.getFileStamp(partial, location, stamp)) return {};
+
+		const auto entry = getEntry(partial, location);
+		FileView file;
+		if (!_platform.mapFile(entry, Location::USER, file) || file.size <= sizeof(CacheEntry)) return {};
+
+		CacheEntry header{};
+		std::memcpy(&header, file.data, sizeof(header));
+		if (std::memcmp(header.magic, CACHE_HEADER, sizeof(header.magic)) != 0) return {};
+		if (header.version != VERSION || header.size != stamp.size) return {};
+
+		// The pack is used where it lies, right after the header
+		FileView pack(file.data + sizeof(CacheEntry), file.size - sizeof(CacheEntry), file.owner);
+		if (header.modified != stamp.modified) {
+			// Touched, but possibly not changed (copied over again, restored from a backup)
+			FileView source;
+			if (!Lz::map(_platform, partial, location, source)) return {};
+			if (hashBytes(source.data, source.size) != header.hash) return {};
+
+			// The entry is written again with the new time, so the pack can't stay mapped out of
+			// it. It's mapped again afterwards, or the pack is loaded from the file this time.
+			const FileView copy(std::make_shared<const std::vector<uint8_t>>(pack.data, pack.data + pack.size));
+			pack = {};
+			file = {};
+			if (!write(entry, stamp, header.hash, copy)) return {};
+			return find(partial, location);
+		}
+
+		return pack;
+	}
+
+	FileView LevelCache::store(const std::string& partial, const Location location, const FileView& data) const {
+		// Always compiled with no index offset, that's added when the pack is mapped
+		std::vector<std::unique_ptr<LevelFactory>> levels;
+		Reader reader(data.data, data.size, _platform, partial.c_str());
+		if (!Load::parseLevels(reader, location, 0, levels)) return {};
+
+		FileStamp stamp{};
+		if (!_platform.getFileStamp(partial, location, stamp)) return {};
+
+		std::ostringstream compiled;
+		Pack::write(compiled, levels, __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+		levels.clear();
+		const auto bytes = compiled.str();
+		const FileView pack(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), nullptr);
+		if (!write(getEntry(partial, location), stamp, hashBytes(data.data, data.size), pack)) {
+			log<Dbg::INFO>(_platform, "cache", [&] {return "cannot write cache for " + partial;});
+			return {};
+		}
+
+		log<Dbg::INFO>(_platform, "cache", [&] {return "cached " + partial;});
+		return find(partial, location);
+	}
+
+	bool LevelCache::findPacks(std::vector<std::pair<Location, std::string>>& packs) const {
+		packs.clear();
+		FileStamp directory{};
+		FileView file;
+		if (_platform.getFileStamp("/", Location::ROM, directory) && _platform.mapFile(MANIFEST, Location::USER, file) && file.size >= sizeof(ManifestHeader)) {
+			ManifestHeader header{};
+			std::memcpy(&header, file.data, sizeof(header));
+			if (std::memcmp(header.magic, MANIFEST_HEADER, sizeof(header.magic)) == 0 && header.modified == directory.modified) {
+				// Anything cut short means the manifest is no good, and the directory is walked after all
+				auto offset = sizeof(ManifestHeader);
+				for (uint32_t i = 0; i < header.count && offset + 2 <= file.size; i++) {
+					const auto location = file.data[offset];
+					const auto length = file.data[offset + 1];
+					offset += 2;
+					if (location > static_cast<uint8_t>(Location::USER) || length > file.size - offset) break;
+					packs.emplace_back(static_cast<Location>(location), std::string(reinterpret_cast<const char*>(file.data + offset), length));
+					offset += length;
+				}
+
+				if (packs.size() == header.count) return true;
+				packs.clear();
+			}
+		}
+
+		packs = _platform.loadUserLevels();
+		return false;
+	}
+
+	void LevelCache::storePacks(const std::vector<std::pair<Location, std::string>>& packs) const {
+		FileStamp directory{};
+		if (!_platform.getFileStamp("/", Location::ROM, directory)) return;
+
+		std::string bytes(sizeof(ManifestHeader), '\0');
+		ManifestHeader header{};
+		std::memcpy(header.magic, MANIFEST_HEADER, sizeof(header.magic));
+		header.count = static_cast<uint32_t>(packs.size());
+		header.modified = directory.modified;
+		std::memcpy(bytes.data(), &header, sizeof(header));
+		for (const auto& pack : packs) {
+			// With a path this long there's no manifest, boot keeps walking the directory
+			if (pack.second.size() > UINT8_MAX) return;
+			bytes += static_cast<char>(pack.first);
+			bytes += static_cast<char>(pack.second.size());
+			bytes += pack.second;
+		}
+
+		auto file = _platform.writeFile(MANIFEST, Location::USER);
+		if (!file) return;
+		file->write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+		file->flush();
+		log<Dbg::INFO>(_platform, "cache", [&] {return "listed " + std::to_string(packs.size()) + " packs";});
+	}
+
+	std::string LevelCache::getEntry(const std::string& partial, const Location location) const {
+		// The same name can be in both locations
+		const auto key = (location == Location::ROM ? "rom:" : "user:") + partial;
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.hax2", static_cast<unsigned long long>(hashBytes(key.data(), key.size())));
+		return CACHE_DIRECTORY + std::string(name);
+	}
+
+	bool LevelCache::write(const std::string& entry, const FileStamp& stamp, const uint64_t hash, const FileView& pack) const {
+		auto file = _platform.writeFile(entry, Location::USER);
+		if (!file) return false;
+
+		CacheEntry header{};
+		std::memcpy(header.magic, CACHE_HEADER, sizeof(header.magic));
+		header.version = VERSION;
+		header.size = stamp.size;
+		header.modified = stamp.modified;
+		header.hash = hash;
+
+		// A torn write leaves a pack shorter than its header says, which fails to load and is compiled again
+		file->write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file->write(reinterpret_cast<const char*>(pack.data), static_cast<std::streamsize>(pack.size));
+		file->flush();
+		return static_cast<bool>(*file);
+	}
+}
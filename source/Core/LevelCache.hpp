@@ -0,0 +1,65 @@
+#ifndef SUPER_HAXAGON_LEVEL_CACHE_HPP
+#define SUPER_HAXAGON_LEVEL_CACHE_HPP
+
+#include "Driver/Platform.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SuperHaxagon {
+	/**
+	 * Keeps the HAX2 form of HAX1.1 packs in the USER location, so the next
+	 * boot maps them instead of parsing them. An entry is used as long as the
+	 * pack still has the size and modification time it was built from. If only
+	 * the time changed, the pack is read and the content hash decides.
+	 *
+	 * It also keeps a manifest of the packs found in the ROM location, so boot
+	 * only walks the directory again once the directory itself has changed.
+	 */
+	class LevelCache {
+	public:
+		static const char* CACHE_HEADER;
+		static const char* CACHE_DIRECTORY;
+		static const char* MANIFEST_HEADER;
+		static const char* MANIFEST;
+		static constexpr uint32_t VERSION = 1;
+
+		explicit LevelCache(Platform& platform);
+
+		/**
+		 * The cached pack for a file, mapped where it lies in the entry, or an
+		 * empty view if there is none, it's stale or it can't be mapped. Nothing
+		 * is validated past the entry header, the caller loads it as a Pack.
+		 */
+		FileView find(const std::string& partial, Location location) const;
+
+		/**
+		 * Compiles a HAX1.1 pack and stores it for the file it was read from.
+		 * Returns the stored pack mapped like find does, or an empty view if any
+		 * of it failed to parse or it couldn't be stored and mapped again.
+		 */
+		FileView store(const std::string& partial, Location location, const FileView& data) const;
+
+		/**
+		 * The packs to load besides the built-in one. Read from the manifest if
+		 * the directory has the modification time it was written for, otherwise
+		 * found with Platform::loadUserLevels. Returns true if the manifest was used.
+		 */
+		bool findPacks(std::vector<std::pair<Location, std::string>>& packs) const;
+
+		/**
+		 * Writes the manifest findPacks reads, for packs that all loaded
+		 */
+		void storePacks(const std::vector<std::pair<Location, std::string>>& packs) const;
+
+	private:
+		std::string getEntry(const std::string& partial, Location location) const;
+		bool write(const std::string& entry, const FileStamp& stamp, uint64_t hash, const FileView& pack) const;
+
+		Platform& _platform;
+	};
+}
+
+#endif //SUPER_HAXAGON_LEVEL_CACHE_HPP
@@ -0,0 +1,20 @@
+#include "Core/Log.hpp"
+
+#include <cstdio>
+
+namespace SuperHaxagon {
+#ifdef HAXAGON_DEBUG_DUMPS
+	void dumpBytes(const Platform& platform, const char* where, const uint8_t* data, const size_t size) {
+		static constexpr size_t PER_LINE = 32;
+		char line[8 + PER_LINE * 2 + 1];
+		for (size_t start = 0; start < size; start += PER_LINE) {
+			auto length = snprintf(line, sizeof(line), "%04zx: ", start);
+			for (auto i = start; i < size && i < start + PER_LINE; i++) {
+				length += snprintf(line + length, sizeof(line) - length, "%02x", data[i]);
+			}
+
+			platform.message(Dbg::INFO, where, line);
+		}
+	}
+#endif
+}
@@ -0,0 +1,44 @@
+#ifndef SUPER_HAXAGON_LOG_HPP
+#define SUPER_HAXAGON_LOG_HPP
+
+#include "Driver/Platform.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Messages below this level aren't built into the game at all: 0 keeps
+// everything, 1 drops INFO, 2 only keeps FATAL.
+#ifndef HAXAGON_LOG_LEVEL
+#define HAXAGON_LOG_LEVEL 0
+#endif
+
+namespace SuperHaxagon {
+	/**
+	 * If messages of this level are built into the game
+	 */
+	constexpr bool isLogged(const Dbg level) {
+		return static_cast<int>(level) >= HAXAGON_LOG_LEVEL;
+	}
+
+	/**
+	 * Sends a message, but only calls format (usually a lambda that
+	 * returns the text) if the level is built in. Anything the message
+	 * is built from costs nothing in builds without it.
+	 */
+	template <Dbg LEVEL, typename F>
+	void log(const Platform& platform, const char* where, F&& format) {
+		if constexpr (isLogged(LEVEL)) platform.message(LEVEL, where, format());
+	}
+
+	/**
+	 * Prints raw bytes (like the whole save) as hex, a line at a time.
+	 * Only builds with HAXAGON_DEBUG_DUMPS print anything.
+	 */
+#ifdef HAXAGON_DEBUG_DUMPS
+	void dumpBytes(const Platform& platform, const char* where, const uint8_t* data, size_t size);
+#else
+	inline void dumpBytes(const Platform&, const char*, const uint8_t*, size_t) {}
+#endif
+}
+
+#endif //SUPER_HAXAGON_LOG_HPP
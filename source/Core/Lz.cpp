@@ -0,0 +1,289 @@
+#include "Core/Lz.hpp"
+
+#include "Core/Structs.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace SuperHaxagon {
+	const char* Lz::LZ_HEADER = "HXZ1";
+
+	static constexpr uint32_t COUNT_MORE = 15;
+	static constexpr size_t HASH_BITS = 14;
+	static constexpr int MAX_CHAIN = 64;
+
+	static void writeCount(std::vector<uint8_t>& out, size_t count) {
+		for (; count >= 255; count -= 255) out.push_back(255);
+		out.push_back(static_cast<uint8_t>(count));
+	}
+
+	static void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals, const size_t count, const size_t offset, const size_t length) {
+		const auto matchCode = length ? length - Lz::MIN_MATCH : 0;
+		out.push_back(static_cast<uint8_t>(std::min<size_t>(count, COUNT_MORE) << 4 | std::min<size_t>(matchCode, COUNT_MORE)));
+		if (count >= COUNT_MORE) writeCount(out, count - COUNT_MORE);
+		out.insert(out.end(), literals, literals + count);
+		if (!length) return;
+
+		out.push_back(static_cast<uint8_t>(offset & 0xFF));
+		out.push_back(static_cast<uint8_t>(offset >> 8));
+		if (matchCode >= COUNT_MORE) writeCount(out, matchCode - COUNT_MORE);
+	}
+
+	std::vector<uint8_t> Lz::compress(const uint8_t* data, const size_t size) {
+		std::vector<uint8_t> out(LZ_HEADER, LZ_HEADER + 4);
+		for (auto i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(size >> (i * 8)));
+
+		// Hash chains over the last WINDOW positions, greedy longest match
+		std::vector<int64_t> head(1 << HASH_BITS, -1);
+		std::vector<int64_t> prev(WINDOW, -1);
+		const auto hashAt = [&](const size_t at) {
+			uint32_t value;
+			std::memcpy(&value, data + at, sizeof(value));
+			return (value * 2654435761u) >> (32 - HASH_BITS);
+		};
+
+		const auto insert = [&](const size_t at) {
+			if (at + MIN_MATCH > size) return;
+			const auto hash = hashAt(at);
+			prev[at % WINDOW] = head[hash];
+			head[hash] = static_cast<int64_t>(at);
+		};
+
+		size_t literals = 0;
+		size_t at = 0;
+		while (at < size) {
+			size_t bestLength = 0;
+			size_t bestOffset = 0;
+			if (at + MIN_MATCH <= size) {
+				auto candidate = head[hashAt(at)];
+				for (auto chain = 0; candidate >= 0 && chain < MAX_CHAIN; chain++) {
+					const auto offset = at - static_cast<size_t>(candidate);
+					if (offset > WINDOW) break;
+
+					const auto max = size - at;
+					size_t length = 0;
+					while (length < max && data[candidate + length] == data[at + length]) length++;
+					if (length > bestLength) {
+						bestLength = length;
+						bestOffset = offset;
+						if (length == max) break;
+					}
+
+					const auto older = prev[candidate % WINDOW];
+					if (older >= candidate) break;
+					candidate = older;
+				}
+			}
+
+			if (bestLength < MIN_MATCH) {
+				insert(at++);
+				continue;
+			}
+
+			writeSequence(out, data + literals, at - literals, bestOffset, bestLength);
+			for (size_t i = 0; i < bestLength; i++) insert(at + i);
+			at += bestLength;
+			literals = at;
+		}
+
+		if (literals < size) writeSequence(out, data + literals, size - literals, 0, 0);
+		return out;
+	}
+
+	std::unique_ptr<std::istream> Lz::open(std::unique_ptr<std::istream> file) {
+		if (!file || !*file) return file;
+
+		const auto start = file->tellg();
+		uint8_t header[HEADER_SIZE];
+		file->read(reinterpret_cast<char*>(header), sizeof(header));
+		if (file->gcount() == sizeof(header) && std::memcmp(header, LZ_HEADER, 4) == 0) {
+			uint32_t size = 0;
+			for (auto i = 0; i < 4; i++) size |= static_cast<uint32_t>(header[4 + i]) << (i * 8);
+
+			// Everything after the header, if the stream knows where it ends
+			const auto data = file->tellg();
+			file->seekg(0, std::ios::end);
+			const auto end = file->tellg();
+			file->clear();
+			file->seekg(data);
+			const auto packed = data >= 0 && end >= data ? static_cast<uint64_t>(end - data) : uint64_t{MAX_SIZE};
+			if (size > MAX_SIZE || size > packed * MAX_RATIO) {
+				file->setstate(std::ios::failbit);
+				return file;
+			}
+
+			return std::make_unique<LzStream>(std::move(file), size);
+		}
+
+		file->clear();
+		file->seekg(start);
+		return file;
+	}
+
+	bool Lz::isCompressed(const std::istream& stream) {
+		return dynamic_cast<const LzStream*>(&stream) != nullptr;
+	}
+
+	bool Lz::map(const Platform& platform, const std::string& partial, const Location location, FileView& view) {
+		auto stream = open(platform.openFile(partial, location));
+		if (!stream || !*stream) return false;
+		if (!isCompressed(*stream)) {
+			stream = nullptr;
+			return platform.mapFile(partial, location, view);
+		}
+
+		view = std::make_shared<const std::vector<uint8_t>>(readAll(*stream));
+		return true;
+	}
+
+	LzBuffer::LzBuffer(std::unique_ptr<std::istream> file, const uint32_t size) :
+		_file(std::move(file)), _size(size), _window(std::min<size_t>(size, 2 * Lz::WINDOW)) {
+		_start = _file->tellg();
+		setg(reinterpret_cast<char*>(_window.data()), reinterpret_cast<char*>(_window.data()), reinterpret_cast<char*>(_window.data()));
+	}
+
+	uint64_t LzBuffer::getPosition() const {
+		if (_seek >= 0) return static_cast<uint64_t>(_seek);
+		return _windowStart + (gptr() - eback());
+	}
+
+	LzBuffer::int_type LzBuffer::underflow() {
+		if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+		const auto target = getPosition();
+		_seek = -1;
+		if (target < _windowStart) restart();
+		while (target >= _windowStart + _filled) {
+			if (!fill()) {
+				auto* end = reinterpret_cast<char*>(_window.data() + _filled);
+				setg(reinterpret_cast<char*>(_window.data()), end, end);
+				return traits_type::eof();
+			}
+		}
+
+		auto* window = reinterpret_cast<char*>(_window.data());
+		setg(window, window + (target - _windowStart), window + _filled);
+		return traits_type::to_int_type(*gptr());
+	}
+
+	LzBuffer::pos_type LzBuffer::seekoff(const off_type off, const std::ios_base::seekdir dir, const std::ios_base::openmode which) {
+		if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+
+		const auto position = static_cast<int64_t>(getPosition());
+		if (dir == std::ios_base::cur && off == 0) return pos_type(off_type(position));
+
+		const auto base = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? position : static_cast<int64_t>(_size);
+		const auto target = base + off;
+		if (target < 0 || target > static_cast<int64_t>(_size)) return pos_type(off_type(-1));
+
+		// Nothing is decoded until something is read, so readAll's seek to the end is free
+		_seek = target;
+		auto* window = reinterpret_cast<char*>(_window.data());
+		setg(window, window, window);
+		return pos_type(off_type(target));
+	}
+
+	LzBuffer::pos_type LzBuffer::seekpos(const pos_type pos, const std::ios_base::openmode which) {
+		return seekoff(off_type(pos), std::ios_base::beg, which);
+	}
+
+	void LzBuffer::restart() {
+		_file->clear();
+		_file->seekg(_start);
+		_filled = 0;
+		_windowStart = 0;
+		_inNext = 0;
+		_inEnd = 0;
+		_literals = 0;
+		_match = 0;
+		_needMatch = false;
+		_broken = !*_file;
+	}
+
+	bool LzBuffer::next(uint8_t& byte) {
+		if (_inNext == _inEnd) {
+			_file->read(reinterpret_cast<char*>(_in), sizeof(_in));
+			_inNext = 0;
+			_inEnd = static_cast<size_t>(_file->gcount());
+			if (_inEnd == 0) return false;
+		}
+
+		byte = _in[_inNext++];
+		return true;
+	}
+
+	bool LzBuffer::readCount(uint32_t& count) {
+		uint8_t more;
+		do {
+			if (!next(more)) return false;
+			count += more;
+		} while (more == 255 && count <= _size);
+
+		return count <= _size;
+	}
+
+	bool LzBuffer::fill() {
+		if (_broken || _windowStart + _filled >= _size) return false;
+
+		// Keep the last WINDOW bytes, that's as far back as a match can reach
+		if (_filled == _window.size()) {
+			std::memmove(_window.data(), _window.data() + Lz::WINDOW, _filled - Lz::WINDOW);
+			_filled -= Lz::WINDOW;
+			_windowStart += Lz::WINDOW;
+		}
+
+		const auto before = _filled;
+		while (_filled < _window.size() && _windowStart + _filled < _size) {
+			const auto room = std::min<uint64_t>(_window.size() - _filled, _size - _windowStart - _filled);
+			if (_literals) {
+				if (_inNext == _inEnd) {
+					uint8_t byte;
+					if (!next(byte)) break;
+					_inNext--;
+				}
+
+				const auto count = static_cast<uint32_t>(std::min<uint64_t>({_literals, _inEnd - _inNext, room}));
+				std::memcpy(_window.data() + _filled, _in + _inNext, count);
+				_inNext += count;
+				_filled += count;
+				_literals -= count;
+				continue;
+			}
+
+			if (_match) {
+				// Byte by byte, a match can overlap what it's copying
+				const auto count = static_cast<uint32_t>(std::min<uint64_t>(_match, room));
+				auto* to = _window.data() + _filled;
+				const auto* from = to - _offset;
+				for (uint32_t i = 0; i < count; i++) to[i] = from[i];
+				_filled += count;
+				_match -= count;
+				continue;
+			}
+
+			if (_needMatch) {
+				uint8_t low;
+				uint8_t high;
+				if (!next(low) || !next(high)) break;
+				_offset = low | static_cast<uint32_t>(high) << 8;
+				uint32_t length = _matchCode;
+				if (length == COUNT_MORE && !readCount(length)) break;
+				if (_offset == 0 || _offset > Lz::WINDOW || _offset > _windowStart + _filled) break;
+				_match = length + static_cast<uint32_t>(Lz::MIN_MATCH);
+				_needMatch = false;
+				continue;
+			}
+
+			uint8_t token;
+			if (!next(token)) break;
+			_literals = token >> 4;
+			if (_literals == COUNT_MORE && !readCount(_literals)) break;
+			_matchCode = token & 0x0F;
+			_needMatch = true;
+		}
+
+		// Stopping early means the data ran out or made no sense
+		if (_filled < _window.size() && _windowStart + _filled < _size) _broken = true;
+		return _filled > before;
+	}
+}
@@ -0,0 +1,116 @@
+#ifndef SUPER_HAXAGON_LZ_HPP
+#define SUPER_HAXAGON_LZ_HPP
+
+#include "Driver/Platform.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace SuperHaxagon {
+	// A compressed file is LZ_HEADER, the size of the file once decompressed
+	// (4 bytes, little endian) then a run of sequences, byte order free:
+	//
+	//   token         high 4 bits literal count, low 4 bits match length - MIN_MATCH
+	//   [count...]    if a nibble is 15, bytes added on until one isn't 255
+	//   literals
+	//   offset        2 bytes little endian, 1 to WINDOW back. Left out once the
+	//   [length...]   literals reach the end of the file, which ends it.
+
+	class Lz {
+	public:
+		static const char* LZ_HEADER;
+		static constexpr size_t HEADER_SIZE = 8;
+		static constexpr size_t WINDOW = 8192;
+		static constexpr size_t MIN_MATCH = 4;
+
+		// The size in the header is only believed up to these. A sequence can't
+		// make more than about 255 bytes for each one it takes.
+		static constexpr uint32_t MAX_RATIO = 255;
+		static constexpr uint32_t MAX_SIZE = 32 * 1024 * 1024;
+
+		/**
+		 * Compresses a whole file, header included. Host tools only, it's not fast.
+		 */
+		static std::vector<uint8_t> compress(const uint8_t* data, size_t size);
+
+		/**
+		 * If file is compressed, a stream that decompresses it as it's read.
+		 * Otherwise file itself, back where it was. Either way it's safe to
+		 * hand in whatever Platform::openFile gave back. A compressed file that
+		 * claims to be bigger than it could be comes back failed.
+		 */
+		static std::unique_ptr<std::istream> open(std::unique_ptr<std::istream> file);
+
+		/**
+		 * Whether open gave back a stream that decompresses
+		 */
+		static bool isCompressed(const std::istream& stream);
+
+		/**
+		 * A whole file in memory. One stored as it is is mapped, a compressed
+		 * one is decompressed from a stream, so its compressed bytes are never
+		 * all in memory next to what they decompress to. False if it can't be read.
+		 */
+		static bool map(const Platform& platform, const std::string& partial, Location location, FileView& view);
+	};
+
+	/**
+	 * Decompresses from a stream into a window of 2 * WINDOW bytes, so only
+	 * that and a small read buffer are ever in memory. Seeking is lazy: it
+	 * costs nothing until the next read, and going backwards starts again.
+	 */
+	class LzBuffer : public std::streambuf {
+	public:
+		LzBuffer(std::unique_ptr<std::istream> file, uint32_t size);
+
+		/**
+		 * False once the compressed data turned out to be broken
+		 */
+		bool isOk() const {return !_broken;}
+
+	protected:
+		int_type underflow() override;
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+		pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+	private:
+		uint64_t getPosition() const;
+		bool fill();
+		void restart();
+		bool next(uint8_t& byte);
+		bool readCount(uint32_t& count);
+
+		std::unique_ptr<std::istream> _file;
+		std::streampos _start;
+		uint32_t _size;
+
+		std::vector<uint8_t> _window;
+		size_t _filled = 0;
+		uint64_t _windowStart = 0; // Position in the file of _window[0]
+		int64_t _seek = -1;        // Where the next read starts, if it was moved
+
+		uint8_t _in[512]{};
+		size_t _inNext = 0;
+		size_t _inEnd = 0;
+
+		uint32_t _literals = 0;
+		uint32_t _match = 0;
+		uint32_t _offset = 0;
+		uint8_t _matchCode = 0;
+		bool _needMatch = false;
+		bool _broken = false;
+	};
+
+	class LzStream : private LzBuffer, public std::istream {
+	public:
+		LzStream(std::unique_ptr<std::istream> file, const uint32_t size) :
+			LzBuffer(std::move(file), size), std::istream(static_cast<std::streambuf*>(this)) {}
+	};
+}
+
+#endif //SUPER_HAXAGON_LZ_HPP
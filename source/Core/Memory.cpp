@@ -0,0 +1,97 @@
+#include "Core/Memory.hpp"
+
+#include "Core/Log.hpp"
+#include "Driver/Platform.hpp"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+
+#include <malloc.h>
+
+namespace SuperHaxagon {
+	static std::array<MemStats, MEM_TAG_LAST> stats{};
+	static const char* TAG_NAMES[MEM_TAG_LAST] = {"fonts", "music", "sounds", "levels", "metadata", "level", "patterns"};
+
+	Memory::Scope::Scope(const MemTag tag) : _tag(tag), _start(getHeapUsed()) {}
+
+	size_t Memory::Scope::finish() {
+		const auto now = getHeapUsed();
+		const auto bytes = now > _start ? now - _start : 0;
+		charge(_tag, bytes);
+		_start = now;
+		return bytes;
+	}
+
+	void Memory::charge(const MemTag tag, const size_t bytes) {
+		auto& stat = stats[static_cast<int>(tag)];
+		stat.current += bytes;
+		if (stat.current > stat.peak) stat.peak = stat.current;
+	}
+
+	void Memory::release(const MemTag tag, const size_t bytes) {
+		auto& stat = stats[static_cast<int>(tag)];
+		stat.current = bytes < stat.current ? stat.current - bytes : 0;
+	}
+
+	const MemStats& Memory::getStats(const MemTag tag) {
+		return stats[static_cast<int>(tag)];
+	}
+
+	const char* Memory::getName(const MemTag tag) {
+		return TAG_NAMES[static_cast<int>(tag)];
+	}
+
+	size_t Memory::getHeapUsed() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+		return mallinfo2().uordblks;
+#else
+		return static_cast<size_t>(mallinfo().uordblks);
+#endif
+	}
+
+	size_t Memory::getHeapFree() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+		return mallinfo2().fordblks;
+#else
+		return static_cast<size_t>(mallinfo().fordblks);
+#endif
+	}
+
+	size_t Memory::getLargestFreeBlock() {
+		// Binary search for the biggest malloc that succeeds. This goes straight
+		// to malloc so it is not counted as an allocation by operator new.
+		size_t low = 0;
+		size_t high = PROBE_LIMIT;
+		while (low < high) {
+			const auto mid = low + (high - low + 1) / 2;
+			auto* probe = std::malloc(mid);
+			if (probe) {
+				std::free(probe);
+				low = mid;
+			} else {
+				high = mid - 1;
+			}
+		}
+
+		return low;
+	}
+
+	void Memory::report(Platform& platform) {
+		// Finding the largest block takes a couple dozen mallocs, skip it all if nobody will see it
+		if constexpr (!isLogged(Dbg::INFO)) return;
+
+		char line[80];
+		for (auto i = MEM_TAG_FIRST; i != MEM_TAG_LAST; i++) {
+			const auto& stat = stats[i];
+			snprintf(line, sizeof(line), "%-8s %7u bytes (peak %7u)", TAG_NAMES[i],
+				static_cast<unsigned>(stat.current), static_cast<unsigned>(stat.peak));
+			platform.message(Dbg::INFO, "memory", line);
+		}
+
+		snprintf(line, sizeof(line), "heap %u used, %u free, %u largest block",
+			static_cast<unsigned>(getHeapUsed()), static_cast<unsigned>(getHeapFree()),
+			static_cast<unsigned>(getLargestFreeBlock()));
+		platform.message(Dbg::INFO, "memory", line);
+	}
+}
@@ -0,0 +1,84 @@
+#ifndef SUPER_HAXAGON_MEMORY_HPP
+#define SUPER_HAXAGON_MEMORY_HPP
+
+#include <cstddef>
+
+namespace SuperHaxagon {
+	class Platform;
+
+	enum class MemTag {
+		FONTS = 0,
+		MUSIC,
+		SOUNDS,
+		LEVELS,   // Parsed LevelFactory and PatternFactory data
+		METADATA, // BGM timestamps
+		LEVEL,    // The live level being played
+		PATTERNS, // Patterns read on demand for the levels being played
+		LAST      // Unused, but used for iteration
+	};
+
+	static constexpr int MEM_TAG_FIRST = static_cast<int>(MemTag::FONTS);
+	static constexpr int MEM_TAG_LAST = static_cast<int>(MemTag::LAST);
+
+	struct MemStats {
+		size_t current;
+		size_t peak;
+	};
+
+	/**
+	 * Tracks how many bytes each subsystem is holding on to, and the most
+	 * it has ever held. Subsystems either charge an exact amount or wrap
+	 * their loading code in a Scope, which charges however much the heap grew.
+	 */
+	class Memory {
+	public:
+		// Upper bound for getLargestFreeBlock, larger than any N64 expansion pak
+		static constexpr size_t PROBE_LIMIT = 8 * 1024 * 1024;
+
+		class Scope {
+		public:
+			explicit Scope(MemTag tag);
+			Scope(Scope&) = delete;
+
+			/**
+			 * Charges the heap growth since construction to the tag and
+			 * returns it, so the owner can release it when it frees the data.
+			 */
+			size_t finish();
+
+		private:
+			MemTag _tag;
+			size_t _start;
+		};
+
+		static void charge(MemTag tag, size_t bytes);
+		static void release(MemTag tag, size_t bytes);
+
+		static const MemStats& getStats(MemTag tag);
+		static const char* getName(MemTag tag);
+
+		/**
+		 * Bytes currently handed out by malloc, including operator new.
+		 */
+		static size_t getHeapUsed();
+
+		/**
+		 * Bytes that are free inside the heap the allocator already owns.
+		 */
+		static size_t getHeapFree();
+
+		/**
+		 * The largest single allocation that would currently succeed, found by
+		 * probing malloc. Fragmentation shows up as this being far below free memory.
+		 * This is slow (a couple dozen mallocs), so only call it for diagnostics.
+		 */
+		static size_t getLargestFreeBlock();
+
+		/**
+		 * Writes every tag's current and peak usage to the platform's log.
+		 */
+		static void report(Platform& platform);
+	};
+}
+
+#endif //SUPER_HAXAGON_MEMORY_HPP
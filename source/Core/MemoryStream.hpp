@@ -0,0 +1,49 @@
+#ifndef SUPER_HAXAGON_MEMORY_STREAM_HPP
+#define SUPER_HAXAGON_MEMORY_STREAM_HPP
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <streambuf>
+
+namespace SuperHaxagon {
+	/**
+	 * Reads straight out of bytes that are already in memory
+	 */
+	class MemoryBuffer : public std::streambuf {
+	public:
+		MemoryBuffer(const uint8_t* data, const size_t size) {
+			auto* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+			setg(begin, begin, begin + size);
+		}
+
+	protected:
+		pos_type seekoff(const off_type off, const std::ios_base::seekdir dir, const std::ios_base::openmode which) override {
+			if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+			const auto base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+			const auto target = base + off;
+			if (target < eback() || target > egptr()) return pos_type(off_type(-1));
+			setg(eback(), target, egptr());
+			return pos_type(target - eback());
+		}
+
+		pos_type seekpos(const pos_type pos, const std::ios_base::openmode which) override {
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+	};
+
+	/**
+	 * An istream over bytes in memory, nothing is copied. owner (if there is
+	 * one) keeps the bytes alive for as long as the stream is around.
+	 */
+	class MemoryStream : private MemoryBuffer, public std::istream {
+	public:
+		MemoryStream(const uint8_t* data, const size_t size, std::shared_ptr<const void> owner = nullptr) :
+			MemoryBuffer(data, size), std::istream(static_cast<std::streambuf*>(this)), _owner(std::move(owner)) {}
+
+	private:
+		std::shared_ptr<const void> _owner;
+	};
+}
+
+#endif //SUPER_HAXAGON_MEMORY_STREAM_HPP
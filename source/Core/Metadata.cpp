@@ -1,58 +1,222 @@
 #include "Core/Metadata.hpp"
 
-#include <sstream>
+#include "Core/Lz.hpp"
+#include "Core/Structs.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
 
 namespace SuperHaxagon {
+	static constexpr size_t BEAT_HEADER_SIZE = 4;
+	static constexpr uint32_t MAX_LABEL = 255;
+	static constexpr uint32_t MAX_MS = (1 << 27) - 1;
+
+	static constexpr auto EARLIER = [](const auto& a, const auto& b) {return a.ms < b.ms;};
+
+	// Indexed by Beat
+	static const char* BEAT_LABELS[BEAT_LAST] = {"S", "I", "BL", "BS", "L0", "L1", "L2", "L3", "L4", "L5", "L6", "HYPER", "PSURROUND", "C"};
+
+	static bool readVarint(const uint8_t*& data, const uint8_t* end, uint32_t& value) {
+		value = 0;
+		for (auto shift = 0; shift < 32; shift += 7) {
+			if (data == end) return false;
+			const auto byte = *data++;
+			value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80)) return true;
+		}
+
+		return false;
+	}
+
+	static void writeVarint(std::ostream& out, uint32_t value) {
+		while (value >= 0x80) {
+			out.put(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+
+		out.put(static_cast<char>(value));
+	}
+
+	FileView Metadata::map(const Platform& platform, const std::string& base, const Location location) {
+		FileView file;
+		if (!Lz::map(platform, base + ".hxb", location, file)) Lz::map(platform, base + ".txt", location, file);
+		return file;
+	}
+
+	Beat Metadata::getBeat(const std::string_view label) {
+		for (auto i = BEAT_FIRST; i != BEAT_LAST; i++) {
+			if (label == BEAT_LABELS[i]) return static_cast<Beat>(i);
+		}
+
+		return Beat::LAST;
+	}
+
+	const char* Metadata::getLabel(const Beat beat) {
+		return beat == Beat::LAST ? "" : BEAT_LABELS[static_cast<int>(beat)];
+	}
+
 	Metadata::Metadata(const std::unique_ptr<std::istream> stream) {
 		if (!stream || !*stream) return;
-		
-		std::string line;
-		while (std::getline(*stream, line)) {
-			std::stringstream values(line);
-			std::string label;
-			float time;
 
-			// time gets repeated by Audacity for the label's
-			// duration. We can ignore it.
-			values >> time;
-			values.ignore(1, '\t');
-			values.ignore(256, '\t');
-			values >> label;
+		const auto data = readAll(*stream);
+		parse(data.data(), data.size());
+	}
+
+	Metadata::Metadata(const uint8_t* data, const size_t size) {
+		parse(data, size);
+	}
 
-			_timestamps[label].push_back(time);
+	void Metadata::parse(const uint8_t* data, const size_t size) {
+		if (size >= BEAT_HEADER_SIZE && std::memcmp(data, BEAT_HEADER, BEAT_HEADER_SIZE) == 0) {
+			// A broken beat map is treated like a missing one
+			if (!parseBeats(data, size)) {
+				_events.clear();
+				_maxTime = 0;
+			}
+		} else {
+			// Audacity writes labels in order, so this is almost never more than a check
+			parseText(data, size);
+			if (!std::is_sorted(_events.begin(), _events.end(), EARLIER)) std::stable_sort(_events.begin(), _events.end(), EARLIER);
 		}
+
 	}
 
-	Metadata::~Metadata() = default;
+	void Metadata::parseText(const uint8_t* data, const size_t size) {
+		const auto* text = reinterpret_cast<const char*>(data);
+		const auto* end = text + size;
+		const auto isSpace = [](const char c) {return c == ' ' || c == '\t' || c == '\r' || c == '\n';};
+		while (text < end) {
+			const auto* lineEnd = std::find(text, end, '\n');
+
+			// start, end and label, split by tabs. end gets repeated
+			// by Audacity for the label's duration. We can ignore it.
+			const auto* startEnd = std::find(text, lineEnd, '\t');
+			const auto* labelStart = startEnd == lineEnd ? lineEnd : std::find(startEnd + 1, lineEnd, '\t');
+			if (labelStart != lineEnd) labelStart++;
+			while (labelStart < lineEnd && isSpace(*labelStart)) labelStart++;
+			auto* labelEnd = labelStart;
+			while (labelEnd < lineEnd && !isSpace(*labelEnd)) labelEnd++;
+
+			// The bytes may not end in a null, so the number is copied out first
+			char number[32]{};
+			std::memcpy(number, text, std::min<size_t>(startEnd - text, sizeof(number) - 1));
+			const auto time = std::strtof(number, nullptr);
+
+			if (lineEnd > text) add(getBeat({labelStart, static_cast<size_t>(labelEnd - labelStart)}), time);
 
-	bool Metadata::getMetadata(const float time, const std::string& label) {
-		if (_timestamps.find(label) == _timestamps.end()) return false; // no data
+			text = lineEnd == end ? end : lineEnd + 1;
+		}
+	}
+
+	bool Metadata::parseBeats(const uint8_t* data, const size_t size) {
+		const auto* end = data + size;
+		data += BEAT_HEADER_SIZE;
+
+		uint32_t labels;
+		if (!readVarint(data, end, labels)) return false;
 
+		// The table first, so the events can be sized before they're read
+		std::vector<std::pair<Beat, uint32_t>> table;
+		size_t total = 0;
+		for (uint32_t i = 0; i < labels; i++) {
+			uint32_t length, count;
+			if (!readVarint(data, end, length) || length > MAX_LABEL || static_cast<size_t>(end - data) < length) return false;
+			const std::string_view label(reinterpret_cast<const char*>(data), length);
+			data += length;
+
+			// Every timestamp is at least a byte, which caps how many there can be
+			if (!readVarint(data, end, count) || (total += count) > size) return false;
+			table.emplace_back(getBeat(label), count);
+		}
+
+		// Each label's times are in order, so every beat goes into one stream
+		// by merging them in as they're read. A frame only has to look at the next event.
+		std::vector<Event> run;
+		std::vector<Event> merged;
+		_events.reserve(total);
+		merged.reserve(total);
+		for (const auto& entry : table) {
+			run.clear();
+			run.reserve(entry.second);
+			uint32_t ms = 0;
+			for (uint32_t i = 0; i < entry.second; i++) {
+				uint32_t delta;
+				if (!readVarint(data, end, delta) || delta > MAX_MS - ms) return false;
+				ms += delta;
+				if (entry.first != Beat::LAST) run.push_back({ms, static_cast<uint32_t>(entry.first)});
+			}
+
+			_maxTime = std::max(_maxTime, static_cast<float>(ms) / BEAT_UNITS);
+			merged.clear();
+			std::merge(_events.begin(), _events.end(), run.begin(), run.end(), std::back_inserter(merged), EARLIER);
+			_events.swap(merged);
+		}
+
+		return data == end;
+	}
+
+	void Metadata::add(const Beat beat, const float time) {
+		_maxTime = std::max(_maxTime, time);
+		if (beat == Beat::LAST) return;
+
+		const auto ms = std::lround(std::max(time, 0.0f) * BEAT_UNITS);
+		_events.push_back({static_cast<uint32_t>(std::min<long>(ms, MAX_MS)), static_cast<uint32_t>(beat)});
+	}
+
+	void Metadata::write(std::ostream& out) const {
+		std::array<uint32_t, BEAT_LAST> counts{};
+		for (const auto& event : _events) counts[event.beat]++;
+
+		out.write(BEAT_HEADER, BEAT_HEADER_SIZE);
+		writeVarint(out, static_cast<uint32_t>(getLabelCount()));
+		for (auto i = BEAT_FIRST; i != BEAT_LAST; i++) {
+			if (!counts[i]) continue;
+			const auto* label = getLabel(static_cast<Beat>(i));
+			const auto length = std::strlen(label);
+			writeVarint(out, static_cast<uint32_t>(length));
+			out.write(label, static_cast<std::streamsize>(length));
+			writeVarint(out, counts[i]);
+		}
+
+		// The events are already in order, so each beat's times are too
+		for (auto i = BEAT_FIRST; i != BEAT_LAST; i++) {
+			uint32_t last = 0;
+			for (const auto& event : _events) {
+				if (event.beat != static_cast<uint32_t>(i)) continue;
+				writeVarint(out, event.ms - last);
+				last = event.ms;
+			}
+		}
+	}
+
+	size_t Metadata::getLabelCount() const {
+		uint32_t seen = 0;
+		for (const auto& event : _events) seen |= 1u << event.beat;
+
+		size_t count = 0;
+		for (; seen; seen &= seen - 1) count++;
+		return count;
+	}
+
+	Metadata::~Metadata() = default;
+
+	uint32_t Metadata::advance(const float time) {
 		// If more than 10 seconds behind, reset
-		if (time < _time - 10) _indices.clear();
+		if (time < _time - 10) _next = 0;
 		_time = time;
 
-		auto event = false;
 		// While not at end and the current timestamp is less than the requested one
-		// Note: C++ crates _indices[label] when it is accessed for the first time
-		while (_indices[label] != _timestamps[label].size() && _timestamps[label][_indices[label]] < time) {
-			_indices[label]++;
-			event = true;
-		}
-		
-		return event;
-	}
-
-	float Metadata::getMaxTime() {
-		auto max = 0.0f;
-		for (const auto& timestamp : _timestamps) {
-			for (auto time : timestamp.second) {
-				if (time > max) {
-					max = time;
-				}
-			}
+		uint32_t beats = 0;
+		const auto now = time * BEAT_UNITS;
+		while (_next != _events.size() && static_cast<float>(_events[_next].ms) < now) {
+			beats |= 1u << _events[_next].beat;
+			_next++;
 		}
 
-		return max;
+		return beats;
 	}
 }
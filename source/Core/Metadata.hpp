@@ -1,27 +1,115 @@
 #ifndef SUPER_HAXAGON_METADATA_HPP
 #define SUPER_HAXAGON_METADATA_HPP
 
-#include <map>
+#include "Driver/Platform.hpp"
+
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace SuperHaxagon {
+	/**
+	 * Every label the game reacts to. Labels in a beat map that aren't
+	 * here are dropped when it's loaded, nothing would ever look at them.
+	 */
+	enum class Beat : uint8_t {
+		SPIN = 0,    // S
+		INVERT,      // I
+		PULSE_LARGE, // BL
+		PULSE_SMALL, // BS
+		LEVEL_0,     // L0 to L6, the win screen switching levels
+		LEVEL_1,
+		LEVEL_2,
+		LEVEL_3,
+		LEVEL_4,
+		LEVEL_5,
+		LEVEL_6,
+		HYPER,       // HYPER
+		SURROUND,    // PSURROUND
+		CREDITS,     // C
+		LAST         // Unused, but used for iteration
+	};
+
+	static constexpr int BEAT_FIRST = static_cast<int>(Beat::SPIN);
+	static constexpr int BEAT_LAST = static_cast<int>(Beat::LAST);
+
+	/**
+	 * The bit for a beat in what Metadata::advance returns
+	 */
+	constexpr uint32_t beatBit(const Beat beat) {
+		return 1u << static_cast<int>(beat);
+	}
+
 	class Metadata {
 	public:
+		// Beat maps compiled by haxbeat start with this instead of label text
+		static constexpr const char* BEAT_HEADER = "HXB1";
+
+		// Compiled timestamps are whole milliseconds
+		static constexpr float BEAT_UNITS = 1000.0f;
+
+		/**
+		 * Maps the beat map for a track: the compiled one (.hxb) if there is
+		 * one, otherwise the label text (.txt). Empty if there's neither.
+		 */
+		static FileView map(const Platform& platform, const std::string& base, Location location);
+
+		/**
+		 * The beat for an Audacity label, or Beat::LAST if the game doesn't use it
+		 */
+		static Beat getBeat(std::string_view label);
+		static const char* getLabel(Beat beat);
+
 		explicit Metadata(std::unique_ptr<std::istream> stream);
+
+		/**
+		 * Reads an Audacity label file or a compiled beat map straight out of memory
+		 */
+		Metadata(const uint8_t* data, size_t size);
 		~Metadata();
 		Metadata& operator=(const Metadata&) = delete;
-		
-		bool getMetadata(float time, const std::string& label);
 
-		float getMaxTime();
+		/**
+		 * Moves up to time and returns a beatBit for every kind of beat that was
+		 * passed on the way. Most frames that's one comparison. Going back more
+		 * than 10 seconds (the track looped) starts over from the beginning.
+		 */
+		uint32_t advance(float time);
+
+		float getMaxTime() const {return _maxTime;}
+
+		/**
+		 * Writes the beats as a compiled beat map. After the header is a table
+		 * of every label and how many timestamps it has, then each label's
+		 * timestamps in order, each as the milliseconds since the one before.
+		 * Every number is a little endian base 128 varint.
+		 */
+		void write(std::ostream& out) const;
+
+		size_t getLabelCount() const;
 
 	private:
+		// Packed into 4 bytes, the same as the bare float times used to take
+		struct Event {
+			uint32_t ms : 27;
+			uint32_t beat : 5;
+		};
+
+		void parse(const uint8_t* data, size_t size);
+		void parseText(const uint8_t* data, size_t size);
+		bool parseBeats(const uint8_t* data, size_t size);
+		void add(Beat beat, float time);
+
+		// Every beat in the track, sorted by time
+		std::vector<Event> _events;
+		size_t _next = 0; // First event that has not fired yet
 		float _time = 0;
-		std::map<std::string, std::vector<float>> _timestamps;
-		std::map<std::string, size_t> _indices;
+		float _maxTime = 0;
 	};
 }
 
-#endif //SUPER_HAXAGON_METADATA_HPP
\ No newline at end of file
+#endif //SUPER_HAXAGON_METADATA_HPP
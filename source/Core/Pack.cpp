@@ -0,0 +1,251 @@
+#include "Core/Pack.hpp"
+
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+#include "Factories/PatternFactory.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <map>
+
+namespace SuperHaxagon {
+	const char* Pack::PACK_HEADER = "HAX2";
+
+	static constexpr bool HOST_BIG_ENDIAN = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+	static constexpr size_t MAX_STRING = 300;
+
+	/**
+	 * Lays out a pack in memory, swapping on the way in if the
+	 * pack is meant for a machine with the other byte order.
+	 */
+	class PackBuilder {
+	public:
+		explicit PackBuilder(const bool swap) : _swap(swap) {}
+
+		uint32_t size() const {return static_cast<uint32_t>(_bytes.size());}
+		const std::vector<uint8_t>& getBytes() const {return _bytes;}
+
+		uint32_t reserve(const size_t bytes) {
+			const auto at = size();
+			_bytes.resize(_bytes.size() + bytes);
+			return at;
+		}
+
+		void align() {
+			while (_bytes.size() % 4) _bytes.push_back(0);
+		}
+
+		void set32(const uint32_t at, uint32_t value) {
+			if (_swap) value = __builtin_bswap32(value);
+			std::memcpy(&_bytes[at], &value, sizeof(value));
+		}
+
+		void setFloat(const uint32_t at, const float value) {
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			set32(at, bits);
+		}
+
+		void put16(uint16_t value) {
+			if (_swap) value = __builtin_bswap16(value);
+			const auto at = reserve(sizeof(value));
+			std::memcpy(&_bytes[at], &value, sizeof(value));
+		}
+
+		void put32(const uint32_t value) {
+			set32(reserve(sizeof(value)), value);
+		}
+
+		void setBytes(const uint32_t at, const void* data, const size_t size) {
+			std::memcpy(&_bytes[at], data, size);
+		}
+
+		void putBytes(const void* data, const size_t size) {
+			setBytes(reserve(size), data, size);
+		}
+
+	private:
+		std::vector<uint8_t> _bytes;
+		bool _swap;
+	};
+
+	bool Pack::isPack(const uint8_t* data, const size_t size) {
+		return size >= sizeof(PackHeader) && std::memcmp(data, PACK_HEADER, 4) == 0;
+	}
+
+	void Pack::write(std::ostream& out, const std::vector<std::unique_ptr<LevelFactory>>& levels, const bool bigEndian) {
+		PackBuilder pack(bigEndian != HOST_BIG_ENDIAN);
+
+		// Only patterns that some level uses are kept
+		std::vector<const PatternFactory*> patterns;
+		std::map<const PatternFactory*, uint32_t> patternIndex;
+		for (const auto& level : levels) {
+			for (const auto& pattern : level->getPatterns()) {
+				if (patternIndex.emplace(pattern.get(), static_cast<uint32_t>(patterns.size())).second) {
+					patterns.push_back(pattern.get());
+				}
+			}
+		}
+
+		const auto header = pack.reserve(sizeof(PackHeader));
+		const auto patternTable = pack.reserve(sizeof(PackPattern) * patterns.size());
+		const auto levelTable = pack.reserve(sizeof(PackLevel) * levels.size());
+
+		// Identical strings are only stored once
+		const auto strings = pack.size();
+		std::map<std::string, uint32_t> stringOffsets;
+		const auto addString = [&](const std::string& str) {
+			const auto found = stringOffsets.find(str);
+			if (found != stringOffsets.end()) return found->second;
+			const auto at = pack.size();
+			pack.put32(static_cast<uint32_t>(str.size()));
+			pack.putBytes(str.c_str(), str.size() + 1);
+			pack.align();
+			stringOffsets.emplace(str, at);
+			return at;
+		};
+
+		for (size_t i = 0; i < patterns.size(); i++) {
+			pack.set32(patternTable + i * sizeof(PackPattern) + offsetof(PackPattern, name), addString(patterns[i]->getName()));
+		}
+
+		for (size_t i = 0; i < levels.size(); i++) {
+			const auto& level = *levels[i];
+			const auto at = static_cast<uint32_t>(levelTable + i * sizeof(PackLevel));
+			pack.set32(at + offsetof(PackLevel, name), addString(level.getName()));
+			pack.set32(at + offsetof(PackLevel, difficulty), addString(level.getDifficulty()));
+			pack.set32(at + offsetof(PackLevel, mode), addString(level.getMode()));
+			pack.set32(at + offsetof(PackLevel, creator), addString(level.getCreator()));
+
+			// Music is stored like in HAX1.1, without the leading slash
+			pack.set32(at + offsetof(PackLevel, music), addString(level.getMusic().substr(1)));
+		}
+
+		const auto stringsSize = pack.size() - strings;
+
+		for (size_t i = 0; i < patterns.size(); i++) {
+			const auto& pattern = *patterns[i];
+			const auto at = static_cast<uint32_t>(patternTable + i * sizeof(PackPattern));
+			pack.set32(at + offsetof(PackPattern, sides), static_cast<uint32_t>(pattern.getSides()));
+			pack.set32(at + offsetof(PackPattern, wallCount), static_cast<uint32_t>(pattern.getWallCount()));
+			pack.set32(at + offsetof(PackPattern, walls), pack.size());
+			for (size_t w = 0; w < pattern.getWallCount(); w++) {
+				const auto& wall = pattern.getWalls()[w];
+				pack.put16(wall.getDistance());
+				pack.put16(wall.getHeight());
+				pack.put16(wall.getSide());
+			}
+
+			pack.align();
+		}
+
+		for (size_t i = 0; i < levels.size(); i++) {
+			const auto& level = *levels[i];
+			const auto at = static_cast<uint32_t>(levelTable + i * sizeof(PackLevel));
+			for (auto c = COLOR_LOCATION_FIRST; c != COLOR_LOCATION_LAST; c++) {
+				const auto& colors = level.getColors().at(static_cast<LocColor>(c));
+				pack.set32(at + offsetof(PackLevel, colorCount) + c * sizeof(uint32_t), static_cast<uint32_t>(colors.size()));
+				pack.set32(at + offsetof(PackLevel, colors) + c * sizeof(uint32_t), pack.size());
+				for (const auto& color : colors) pack.putBytes(&color, sizeof(Color));
+			}
+
+			pack.setFloat(at + offsetof(PackLevel, speedWall), level.getSpeedWall());
+			pack.setFloat(at + offsetof(PackLevel, speedRotation), level.getSpeedRotation());
+			pack.setFloat(at + offsetof(PackLevel, speedCursor), level.getSpeedCursor());
+			pack.set32(at + offsetof(PackLevel, speedPulse), static_cast<uint32_t>(level.getSpeedPulse()));
+			pack.set32(at + offsetof(PackLevel, nextIndex), static_cast<uint32_t>(level.getNextIndex()));
+			pack.setFloat(at + offsetof(PackLevel, nextTime), level.getNextTime());
+			pack.set32(at + offsetof(PackLevel, patternCount), static_cast<uint32_t>(level.getPatterns().size()));
+			pack.set32(at + offsetof(PackLevel, patterns), pack.size());
+			for (const auto& pattern : level.getPatterns()) pack.put32(patternIndex.at(pattern.get()));
+		}
+
+		pack.setBytes(header + offsetof(PackHeader, magic), PACK_HEADER, 4);
+		pack.set32(header + offsetof(PackHeader, order), ORDER_MARK);
+		pack.set32(header + offsetof(PackHeader, version), VERSION);
+		pack.set32(header + offsetof(PackHeader, size), pack.size());
+		pack.set32(header + offsetof(PackHeader, patternCount), static_cast<uint32_t>(patterns.size()));
+		pack.set32(header + offsetof(PackHeader, patterns), patternTable);
+		pack.set32(header + offsetof(PackHeader, levelCount), static_cast<uint32_t>(levels.size()));
+		pack.set32(header + offsetof(PackHeader, levels), levelTable);
+		pack.set32(header + offsetof(PackHeader, strings), strings);
+		pack.set32(header + offsetof(PackHeader, stringsSize), stringsSize);
+		out.write(reinterpret_cast<const char*>(pack.getBytes().data()), pack.size());
+	}
+
+	Pack::Pack(FileView file, Platform& platform, const char* name) : _file(std::move(file)) {
+		_loaded = validate(platform, name);
+	}
+
+	std::string_view Pack::getString(const uint32_t offset) const {
+		return {get<char>(offset + sizeof(uint32_t)), *get<uint32_t>(offset)};
+	}
+
+	bool Pack::range(const uint32_t offset, const size_t count, const size_t size) const {
+		const auto bytes = _file.size;
+		return offset % 4 == 0 && offset <= bytes && count <= (bytes - offset) / size;
+	}
+
+	bool Pack::string(const uint32_t offset) const {
+		const auto& header = getHeader();
+		if (offset < header.strings || offset >= header.strings + header.stringsSize) return false;
+		if (!range(offset, 1, sizeof(uint32_t))) return false;
+		const auto length = *get<uint32_t>(offset);
+		return length <= MAX_STRING && range(offset + sizeof(uint32_t), length + 1, 1) && *get<char>(offset + sizeof(uint32_t) + length) == '\0';
+	}
+
+	bool Pack::validate(Platform& platform, const char* name) const {
+		const auto fail = [&](const char* problem) {
+			platform.message(Dbg::WARN, "pack", std::string(name) + ": " + problem);
+			return false;
+		};
+
+		if (!isPack(_file.data, _file.size)) return fail("not a HAX2 pack");
+		if (reinterpret_cast<uintptr_t>(_file.data) % 4 != 0) return fail("pack is not 4 byte aligned in memory");
+
+		const auto& header = getHeader();
+		if (header.order == __builtin_bswap32(ORDER_MARK)) return fail("pack was compiled for the other byte order");
+		if (header.order != ORDER_MARK) return fail("byte order mark invalid");
+		if (header.version != VERSION) return fail("unsupported pack version");
+		if (header.size != _file.size) return fail("pack size does not match the file");
+		if (header.patternCount < 1 || header.patternCount > 300) return fail("pattern count out of range");
+		if (header.levelCount < 1 || header.levelCount > 300) return fail("level count out of range");
+		if (!range(header.patterns, header.patternCount, sizeof(PackPattern))) return fail("pattern table out of bounds");
+		if (!range(header.levels, header.levelCount, sizeof(PackLevel))) return fail("level table out of bounds");
+		if (!range(header.strings, header.stringsSize, 1)) return fail("string table out of bounds");
+
+		// Walls are used where they lie, so they are held to what WallFactory clamps a HAX1.1 wall to
+		for (uint32_t i = 0; i < header.patternCount; i++) {
+			const auto& pattern = getPattern(i);
+			if (!string(pattern.name)) return fail("pattern name invalid");
+			if (pattern.sides < 3 || pattern.sides > 256) return fail("pattern sides out of range");
+			if (pattern.wallCount < 1 || pattern.wallCount > 1000) return fail("pattern wall count out of range");
+			if (!range(pattern.walls, pattern.wallCount, sizeof(uint16_t) * 3)) return fail("pattern walls out of bounds");
+			const auto* walls = get<uint16_t>(pattern.walls);
+			for (uint32_t w = 0; w < pattern.wallCount; w++) {
+				if (walls[w * 3 + 1] < WallFactory::MIN_WALL_HEIGHT) return fail("wall height out of range");
+				if (walls[w * 3 + 2] >= pattern.sides) return fail("wall side out of range");
+			}
+		}
+
+		for (uint32_t i = 0; i < header.levelCount; i++) {
+			const auto& level = getLevel(i);
+			if (!string(level.name) || !string(level.difficulty) || !string(level.mode) || !string(level.creator) || !string(level.music)) return fail("level string invalid");
+			for (auto c = COLOR_LOCATION_FIRST; c != COLOR_LOCATION_LAST; c++) {
+				if (level.colorCount[c] < 1 || level.colorCount[c] > 512) return fail("level color count out of range");
+				if (!range(level.colors[c], level.colorCount[c], sizeof(Color))) return fail("level colors out of bounds");
+			}
+
+			if (level.speedPulse < 4 || level.speedPulse > 8192) return fail("level pulse out of range");
+			if (level.nextIndex < -1 || level.nextIndex > 8192) return fail("level next index out of range");
+			if (level.patternCount < 1 || level.patternCount > 512) return fail("level pattern count out of range");
+			if (!range(level.patterns, level.patternCount, sizeof(uint32_t))) return fail("level patterns out of bounds");
+			const auto* indices = get<uint32_t>(level.patterns);
+			for (uint32_t p = 0; p < level.patternCount; p++) {
+				if (indices[p] >= header.patternCount) return fail("level pattern index out of range");
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,106 @@
+#ifndef SUPER_HAXAGON_PACK_HPP
+#define SUPER_HAXAGON_PACK_HPP
+
+#include "Core/Structs.hpp"
+#include "Driver/Platform.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+namespace SuperHaxagon {
+	class LevelFactory;
+
+	// HAX2 is the "use it in place" version of a level pack. Everything is in
+	// the byte order of the machine that loads it and 4 byte aligned, and all
+	// references are byte offsets from the start of the file. Strings are a
+	// uint32 length, the characters and a null, padded to 4 bytes.
+
+	struct PackHeader {
+		char magic[4];         // "HAX2"
+		uint32_t order;        // Pack::ORDER_MARK as written by the compiler
+		uint32_t version;
+		uint32_t size;         // Of the whole file
+		uint32_t patternCount;
+		uint32_t patterns;     // -> PackPattern[patternCount]
+		uint32_t levelCount;
+		uint32_t levels;       // -> PackLevel[levelCount]
+		uint32_t strings;      // Start of the string table
+		uint32_t stringsSize;
+	};
+
+	struct PackPattern {
+		uint32_t name;         // -> string
+		uint32_t sides;
+		uint32_t wallCount;
+		uint32_t walls;        // -> uint16_t[wallCount][3] distance, height, side
+	};
+
+	struct PackLevel {
+		uint32_t name;         // -> string
+		uint32_t difficulty;   // -> string
+		uint32_t mode;         // -> string
+		uint32_t creator;      // -> string
+		uint32_t music;        // -> string
+		uint32_t colorCount[COLOR_LOCATION_LAST];
+		uint32_t colors[COLOR_LOCATION_LAST]; // -> Color[colorCount], indexed by LocColor
+		float speedWall;
+		float speedRotation;
+		float speedCursor;
+		int32_t speedPulse;
+		int32_t nextIndex;
+		float nextTime;
+		uint32_t patternCount;
+		uint32_t patterns;     // -> uint32_t[patternCount] indices into the pattern table
+	};
+
+	/**
+	 * A validated HAX2 pack. Only the tables are checked when it's created,
+	 * after that walls and colors are read straight out of the buffer.
+	 */
+	class Pack {
+	public:
+		static const char* PACK_HEADER;
+		static constexpr uint32_t ORDER_MARK = 0x01020304;
+		static constexpr uint32_t VERSION = 1;
+
+		static bool isPack(const uint8_t* data, size_t size);
+
+		/**
+		 * Writes levels (and the patterns they use) as a HAX2 pack for a
+		 * machine with the given byte order.
+		 */
+		static void write(std::ostream& out, const std::vector<std::unique_ptr<LevelFactory>>& levels, bool bigEndian);
+
+		Pack(FileView file, Platform& platform, const char* name);
+
+		bool isLoaded() const {return _loaded;}
+		const PackHeader& getHeader() const {return *get<PackHeader>(0);}
+		const PackPattern& getPattern(const size_t i) const {return get<PackPattern>(getHeader().patterns)[i];}
+		const PackLevel& getLevel(const size_t i) const {return get<PackLevel>(getHeader().levels)[i];}
+		std::string_view getString(uint32_t offset) const;
+
+		/**
+		 * Keeps the bytes alive for whatever points into them
+		 */
+		const std::shared_ptr<const void>& getOwner() const {return _file.owner;}
+
+		template <typename T>
+		const T* get(const uint32_t offset) const {
+			return reinterpret_cast<const T*>(_file.data + offset);
+		}
+
+	private:
+		bool validate(Platform& platform, const char* name) const;
+		bool range(uint32_t offset, size_t count, size_t size) const;
+		bool string(uint32_t offset) const;
+
+		FileView _file;
+		bool _loaded = false;
+	};
+}
+
+#endif //SUPER_HAXAGON_PACK_HPP
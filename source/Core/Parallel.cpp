@@ -0,0 +1,158 @@
+#include "Core/Parallel.hpp"
+
+#include <algorithm>
+
+#ifdef HAXAGON_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#if __cpp_exceptions
+#include <exception>
+#endif
+
+namespace SuperHaxagon {
+#ifdef HAXAGON_THREADS
+	// Where messages go while this thread runs a job
+	static thread_local std::vector<Message>* queue = nullptr;
+#else
+	static std::vector<Message>* queue = nullptr;
+#endif
+
+	/**
+	 * Runs one job with its messages kept in its report
+	 */
+	static void runJob(const std::function<void(size_t)>& job, const size_t i, JobReport& report) {
+		queue = &report.messages;
+#if __cpp_exceptions
+		try {
+			job(i);
+		} catch (const std::exception& e) {
+			report.failed = true;
+			report.error = e.what();
+		} catch (...) {
+			report.failed = true;
+			report.error = "unknown error";
+		}
+#else
+		job(i);
+#endif
+		queue = nullptr;
+	}
+
+#ifdef HAXAGON_THREADS
+	struct WorkerPool::Threads {
+		std::mutex mutex;
+		std::condition_variable wake;
+		std::condition_variable done;
+		std::vector<std::thread> threads;
+
+		// The batch being worked on, workers copy it when they join in
+		const std::function<void(size_t)>* job = nullptr;
+		std::vector<JobReport>* reports = nullptr;
+		size_t count = 0;
+		std::atomic<size_t> next{0};
+
+		size_t batch = 0;    // Bumped by every run, so each worker joins it exactly once
+		size_t finished = 0; // Workers done with this batch
+		bool stop = false;
+
+		void work(const std::function<void(size_t)>& batchJob, std::vector<JobReport>& batchReports, const size_t batchCount) {
+			for (auto i = next++; i < batchCount; i = next++) runJob(batchJob, i, batchReports[i]);
+		}
+
+		void loop() {
+			size_t seen = 0;
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true) {
+				wake.wait(lock, [&] {return stop || batch != seen;});
+				if (stop) return;
+				seen = batch;
+				const auto& batchJob = *job;
+				auto& batchReports = *reports;
+				const auto batchCount = count;
+				lock.unlock();
+				work(batchJob, batchReports, batchCount);
+				lock.lock();
+				if (++finished == threads.size()) done.notify_one();
+			}
+		}
+	};
+#else
+	struct WorkerPool::Threads {};
+#endif
+
+	size_t getWorkerCount() {
+#ifdef HAXAGON_THREADS
+		return std::max(1u, std::thread::hardware_concurrency());
+#else
+		return 1;
+#endif
+	}
+
+	WorkerPool::WorkerPool(const size_t workers) : _workers(workers ? workers : getWorkerCount()) {
+#ifdef HAXAGON_THREADS
+		if (_workers <= 1) return;
+		_threads = std::make_unique<Threads>();
+		_threads->threads.reserve(_workers - 1);
+		for (size_t i = 1; i < _workers; i++) _threads->threads.emplace_back([this] {_threads->loop();});
+#else
+		_workers = 1;
+#endif
+	}
+
+	WorkerPool::~WorkerPool() {
+#ifdef HAXAGON_THREADS
+		if (!_threads) return;
+		{
+			std::lock_guard<std::mutex> lock(_threads->mutex);
+			_threads->stop = true;
+		}
+
+		_threads->wake.notify_all();
+		for (auto& thread : _threads->threads) thread.join();
+#endif
+	}
+
+	void WorkerPool::run(const size_t count, const std::function<void(size_t)>& job, std::vector<JobReport>& reports) {
+		reports.clear();
+		reports.resize(count);
+
+#ifdef HAXAGON_THREADS
+		if (_threads && count > 1) {
+			auto& threads = *_threads;
+			{
+				std::lock_guard<std::mutex> lock(threads.mutex);
+				threads.job = &job;
+				threads.reports = &reports;
+				threads.count = count;
+				threads.next = 0;
+				threads.finished = 0;
+				threads.batch++;
+			}
+
+			threads.wake.notify_all();
+			threads.work(job, reports, count);
+
+			// Every worker has to be done with job and reports before they go away
+			std::unique_lock<std::mutex> lock(threads.mutex);
+			threads.done.wait(lock, [&] {return threads.finished == threads.threads.size();});
+			return;
+		}
+#endif
+
+		for (size_t i = 0; i < count; i++) runJob(job, i, reports[i]);
+	}
+
+	bool queueMessage(const Dbg level, const std::string& where, const std::string& message) {
+		if (!queue) return false;
+		queue->push_back({level, where, message});
+		return true;
+	}
+
+	void sendMessages(const Platform& platform, const JobReport& report) {
+		for (const auto& message : report.messages) platform.message(message.level, message.where, message.text);
+	}
+}
@@ -0,0 +1,83 @@
+#ifndef SUPER_HAXAGON_PARALLEL_HPP
+#define SUPER_HAXAGON_PARALLEL_HPP
+
+#include "Driver/Platform.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The N64 and Nspire have a single core and no std::thread. Elsewhere, trust
+// libstdc++ and libc++ to say whether they were built with threads.
+#if !defined(N64) && !defined(_TINSPIRE) && (defined(_GLIBCXX_HAS_GTHREADS) || (defined(_LIBCPP_VERSION) && !defined(_LIBCPP_HAS_NO_THREADS)) || defined(_MSC_VER))
+#define HAXAGON_THREADS 1
+#endif
+
+namespace SuperHaxagon {
+	/**
+	 * Threads a WorkerPool has by default, one per core.
+	 * Always 1 on platforms without threads (N64, Nspire).
+	 */
+	size_t getWorkerCount();
+
+	/**
+	 * A message a job sent while it ran on a WorkerPool
+	 */
+	struct Message {
+		Dbg level;
+		std::string where;
+		std::string text;
+	};
+
+	/**
+	 * What a job left behind: the messages it sent, in order, and what it
+	 * threw if it didn't finish.
+	 */
+	struct JobReport {
+		std::vector<Message> messages;
+		std::string error;
+		bool failed = false;
+	};
+
+	/**
+	 * Threads that are started once and then take jobs until the pool is
+	 * gone. The calling thread works too, so a pool of one has no threads.
+	 */
+	class WorkerPool {
+	public:
+		explicit WorkerPool(size_t workers = 0);
+		WorkerPool(WorkerPool&) = delete;
+		~WorkerPool();
+
+		size_t getWorkers() const {return _workers;}
+
+		/**
+		 * Calls job(0) to job(count - 1) and waits for all of them. Jobs run in
+		 * no particular order, so they can't depend on each other. Their
+		 * messages are kept in reports[i] instead of being sent, and a job
+		 * that throws is marked as failed there instead of ending the game.
+		 */
+		void run(size_t count, const std::function<void(size_t)>& job, std::vector<JobReport>& reports);
+
+	private:
+		struct Threads;
+
+		std::unique_ptr<Threads> _threads;
+		size_t _workers;
+	};
+
+	/**
+	 * Keeps a message for the job running on this thread, false if there is
+	 * none. Platform::message tries this first, so workers never print.
+	 */
+	bool queueMessage(Dbg level, const std::string& where, const std::string& message);
+
+	/**
+	 * Sends the messages a job kept, from the calling thread
+	 */
+	void sendMessages(const Platform& platform, const JobReport& report);
+}
+
+#endif //SUPER_HAXAGON_PARALLEL_HPP
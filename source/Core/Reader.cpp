@@ -0,0 +1,40 @@
+#include "Core/Reader.hpp"
+
+#include "Core/Log.hpp"
+#include "Driver/Platform.hpp"
+
+#include <cstdio>
+
+namespace SuperHaxagon {
+	Reader::Reader(const uint8_t* data, const size_t size, Platform& platform, const char* name) :
+		_data(data),
+		_size(size),
+		_platform(platform),
+		_name(name)
+	{}
+
+	void Reader::fail(const char* noun, const char* problem) {
+		if (_failed) return;
+		report(noun, problem, _offset);
+		_failed = true;
+	}
+
+	void Reader::report(const char* noun, const char* problem, const size_t offset) {
+		_problems++;
+		log<Dbg::WARN>(_platform, "reader", [&] {
+			char where[32];
+			snprintf(where, sizeof(where), " at offset 0x%zx", offset);
+			return std::string(_name) + ": " + noun + " " + problem + where;
+		});
+	}
+
+	int32_t Reader::clamp(const int32_t num, const int32_t min, const int32_t max, const char* noun) {
+		_problems++;
+		log<Dbg::WARN>(_platform, "reader", [&] {
+			char where[96];
+			snprintf(where, sizeof(where), " (%ld, expected %ld to %ld) at offset 0x%zx", static_cast<long>(num), static_cast<long>(min), static_cast<long>(max), _offset - sizeof(num));
+			return std::string(_name) + ": " + noun + (num < min ? " is too small" : " is too large") + where + ", but continuing anyway.";
+		});
+		return num < min ? min : max;
+	}
+}
@@ -0,0 +1,152 @@
+#ifndef SUPER_HAXAGON_READER_HPP
+#define SUPER_HAXAGON_READER_HPP
+
+#include "Core/Structs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace SuperHaxagon {
+	class Platform;
+
+	/**
+	 * Bounds checked reader over a block of little endian bytes, used to parse
+	 * level packs in one pass without going through a stream per field.
+	 *
+	 * The first problem (running off the end, a bad header) is reported with
+	 * the offset it happened at. After that the reader is failed: every read
+	 * returns zeros and nothing more is reported. Values that are clamped
+	 * are reported too, but reading carries on.
+	 */
+	class Reader {
+	public:
+		Reader(const uint8_t* data, size_t size, Platform& platform, const char* name);
+
+		bool isOk() const {return !_failed;}
+		size_t getProblems() const {return _problems;}
+		size_t getOffset() const {return _offset;}
+		size_t getSize() const {return _size;}
+		const uint8_t* getData() const {return _data;}
+		Platform& getPlatform() const {return _platform;}
+
+		/**
+		 * Compares the next bytes to an expected tag like "PTN1.1"
+		 */
+		bool compare(const char* tag, const char* noun) {
+			const auto length = std::strlen(tag);
+			if (!has(length, noun)) return false;
+			if (std::memcmp(_data + _offset, tag, length) != 0) {
+				fail(noun, "is invalid");
+				return false;
+			}
+
+			_offset += length;
+			return true;
+		}
+
+		/**
+		 * Reads an integer, clamping (and warning) if it is out of range
+		 */
+		int32_t read32(const int32_t min, const int32_t max, const char* noun) {
+			const auto num = static_cast<int32_t>(load<uint32_t>(noun));
+			if (num < min || num > max) return clamp(num, min, max, noun);
+			return num;
+		}
+
+		int16_t read16(const char* noun) {
+			return static_cast<int16_t>(load<uint16_t>(noun));
+		}
+
+		float readFloat(const char* noun) {
+			const auto bits = load<uint32_t>(noun);
+			float num;
+			std::memcpy(&num, &bits, sizeof(num));
+			return num;
+		}
+
+		Color readColor(const char* noun) {
+			if (!has(3, noun)) return {0, 0, 0, 0xFF};
+			const Color color{_data[_offset], _data[_offset + 1], _data[_offset + 2], 0xFF};
+			_offset += 3;
+			return color;
+		}
+
+		/**
+		 * Reads a length prefixed string without copying it. The view
+		 * points into the reader's data, so it lives as long as that does.
+		 */
+		std::string_view readView(const char* noun) {
+			const auto length = static_cast<size_t>(read32(1, 300, noun));
+			if (!has(length, noun)) return {};
+			const std::string_view view(reinterpret_cast<const char*>(_data + _offset), length);
+			_offset += length;
+
+			// The stream version stopped at the first null, keep doing that
+			const auto end = view.find('\0');
+			return end == std::string_view::npos ? view : view.substr(0, end);
+		}
+
+		std::string readString(const char* noun) {
+			return std::string(readView(noun));
+		}
+
+		/**
+		 * Steps over bytes that are not needed right now
+		 */
+		bool skip(const size_t bytes, const char* noun) {
+			if (!has(bytes, noun)) return false;
+			_offset += bytes;
+			return true;
+		}
+
+		/**
+		 * Reports a problem at the current offset and fails the reader
+		 */
+		void fail(const char* noun, const char* problem);
+
+		/**
+		 * Reports a problem at some offset without failing the reader
+		 */
+		void report(const char* noun, const char* problem, size_t offset);
+
+	private:
+		// Level files are little endian, so only big endian targets (like the N64) swap
+		static constexpr bool SWAP = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+		bool has(const size_t bytes, const char* noun) {
+			if (_failed) return false;
+			if (_size - _offset >= bytes) return true;
+			fail(noun, "runs past the end of the file");
+			return false;
+		}
+
+		template <typename T>
+		T load(const char* noun) {
+			if (!has(sizeof(T), noun)) return 0;
+			T num;
+			std::memcpy(&num, _data + _offset, sizeof(T));
+			_offset += sizeof(T);
+			if (SWAP) {
+				if (sizeof(T) == 2) num = static_cast<T>(__builtin_bswap16(static_cast<uint16_t>(num)));
+				else num = static_cast<T>(__builtin_bswap32(static_cast<uint32_t>(num)));
+			}
+
+			return num;
+		}
+
+		int32_t clamp(int32_t num, int32_t min, int32_t max, const char* noun);
+
+		const uint8_t* _data;
+		size_t _size;
+		size_t _offset = 0;
+		Platform& _platform;
+		const char* _name;
+		size_t _problems = 0;
+		bool _failed = false;
+	};
+}
+
+#endif //SUPER_HAXAGON_READER_HPP
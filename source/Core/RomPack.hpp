@@ -0,0 +1,51 @@
+#ifndef SUPER_HAXAGON_ROM_PACK_HPP
+#define SUPER_HAXAGON_ROM_PACK_HPP
+
+#include "Core/Structs.hpp"
+
+#include <cstdint>
+
+namespace SuperHaxagon {
+	class WallFactory;
+
+	// The built-in levels as tables that are compiled into the game (see
+	// haxc --cpp), so they're used from read-only memory without reading or
+	// parsing anything. The same layout as HAX2, but with pointers for offsets.
+
+	struct RomPattern {
+		const char* name;
+		uint32_t sides;
+		uint32_t wallCount;
+		const WallFactory* walls;
+	};
+
+	struct RomLevel {
+		const char* name;
+		const char* difficulty;
+		const char* mode;
+		const char* creator;
+		const char* music;     // Without the leading slash, like in a pack
+		uint32_t colorCount[COLOR_LOCATION_LAST];
+		const Color* colors[COLOR_LOCATION_LAST]; // Indexed by LocColor
+		float speedWall;
+		float speedRotation;
+		float speedCursor;
+		int32_t speedPulse;
+		int32_t nextIndex;
+		float nextTime;
+		uint32_t patternCount;
+		const uint16_t* patterns; // Indices into RomPack::patterns
+	};
+
+	struct RomPack {
+		uint32_t patternCount;
+		const RomPattern* patterns;
+		uint32_t levelCount;
+		const RomLevel* levels;
+	};
+
+	// Only exists in builds with HAXAGON_EMBEDDED_LEVELS
+	extern const RomPack ROM_PACK;
+}
+
+#endif //SUPER_HAXAGON_ROM_PACK_HPP
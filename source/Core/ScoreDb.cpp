@@ -0,0 +1,274 @@
+#include "Core/ScoreDb.hpp"
+
+#include "Core/Log.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace SuperHaxagon {
+	const char* ScoreDb::SCORE_HEADER = "HXS";
+	const char* ScoreDb::LEGACY_HEADER = "SCDB1.0";
+
+	static constexpr size_t MAGIC_SIZE = 3;
+	static constexpr size_t CHECKED_SIZE = ScoreDb::RECORD_SIZE - 1;
+	static constexpr uint64_t ALL_BLOCKS = (uint64_t{1} << (ScoreDb::JOURNAL_BLOCK + 1)) - 1;
+	static_assert(ScoreDb::JOURNAL_BLOCK < 64, "every block needs a bit in the dirty mask");
+
+	// Header: "HXS", version, record size, two reserved bytes, check byte.
+	// Record: id (4 bytes), score (3 bytes), both little endian, check byte.
+	// A record with an id of 0 is empty, which is what a wiped save is full of.
+	// The journal block after the records is laid out like a record.
+
+	/**
+	 * CRC-8 (polynomial 0x07) of the first 7 bytes of a block
+	 */
+	static uint8_t getCheck(const uint8_t* block) {
+		uint8_t crc = 0xFF;
+		for (size_t i = 0; i < CHECKED_SIZE; i++) {
+			crc ^= block[i];
+			for (auto bit = 0; bit < 8; bit++) crc = static_cast<uint8_t>(crc & 0x80 ? crc << 1 ^ 0x07 : crc << 1);
+		}
+
+		return crc;
+	}
+
+	static uint32_t getRecordId(const uint8_t* record) {
+		return record[0] | record[1] << 8 | record[2] << 16 | static_cast<uint32_t>(record[3]) << 24;
+	}
+
+	static uint32_t getRecordScore(const uint8_t* record) {
+		return record[4] | record[5] << 8 | static_cast<uint32_t>(record[6]) << 16;
+	}
+
+	ScoreDb::ScoreDb(Platform& platform) : _platform(platform) {
+		format();
+	}
+
+	uint32_t ScoreDb::getId(const std::string_view name, const std::string_view difficulty, const std::string_view mode, const std::string_view creator) {
+		// FNV-1a, with a 0 after each string so moving letters between them changes the id
+		uint32_t hash = 2166136261u;
+		for (const auto part : {name, difficulty, mode, creator}) {
+			for (const auto c : part) hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+			hash *= 16777619u;
+		}
+
+		return hash ? hash : 1;
+	}
+
+	uint32_t ScoreDb::getId(const LevelFactory& level) {
+		return getId(level.getName(), level.getDifficulty(), level.getMode(), level.getCreator());
+	}
+
+	bool ScoreDb::read(const std::vector<std::unique_ptr<LevelFactory>>& levels) {
+		log<Dbg::INFO>(_platform, "scores", [] {return "reading /scores.db";});
+		std::vector<uint8_t> data(SAVE_SIZE);
+		if (!_platform.readSave(data.data(), data.size())) {
+			// Whatever is there is replaced as a whole, never mixed with new records
+			_platform.message(Dbg::WARN, "scores", "save read unsuccessful");
+			_dirty = ALL_BLOCKS;
+			return false;
+		}
+
+		dumpBytes(_platform, "scores", data.data(), data.size());
+
+		const auto* header = data.data();
+		if (std::memcmp(header, LEGACY_HEADER, std::strlen(LEGACY_HEADER)) == 0) {
+			// Scores from before are moved over, the new save is written after the next game
+			if (!readLegacy(header, data.size())) _platform.message(Dbg::WARN, "scores", "old save is cut short, kept what was before that");
+			_dirty = ALL_BLOCKS;
+		} else if (std::memcmp(header, SCORE_HEADER, MAGIC_SIZE) != 0 || header[MAGIC_SIZE] != VERSION || header[MAGIC_SIZE + 1] != RECORD_SIZE || header[CHECKED_SIZE] != getCheck(header)) {
+			// Also what a new or wiped save looks like, then the records are empty already
+			log<Dbg::INFO>(_platform, "scores", [] {return "no score database";});
+			const auto wiped = std::all_of(data.begin(), data.end(), [](const uint8_t byte) {return byte == 0;});
+			_dirty = wiped ? uint64_t{1} : ALL_BLOCKS;
+		} else {
+			_save = std::move(data);
+		}
+
+		std::unordered_map<uint32_t, LevelFactory*> ids;
+		ids.reserve(levels.size());
+		for (const auto& level : levels) ids.emplace(getId(*level), level.get());
+
+		// Every record once, a record that fails its check is dropped
+		_count = 0;
+		for (size_t slot = 0; slot < RECORD_COUNT; slot++) {
+			auto* record = &_save[(slot + 1) * RECORD_SIZE];
+			const auto id = getRecordId(record);
+			if (id == 0) continue;
+			if (record[CHECKED_SIZE] != getCheck(record)) {
+				_platform.message(Dbg::WARN, "scores", "record " + std::to_string(slot) + " is broken, dropped");
+				std::fill(record, record + RECORD_SIZE, 0);
+				_dirty |= uint64_t{1} << (slot + 1);
+				continue;
+			}
+
+			_count++;
+			const auto found = ids.find(id);
+			_installed[slot] = found != ids.end();
+			if (_installed[slot]) found->second->setHighScore(static_cast<int>(getRecordScore(record)));
+		}
+
+		// The record written last. If its own block didn't make it, this puts it back.
+		const auto* journal = &_save[JOURNAL_BLOCK * RECORD_SIZE];
+		const auto journalId = getRecordId(journal);
+		if (journalId != 0 && journal[CHECKED_SIZE] == getCheck(journal)) {
+			const auto score = getRecordScore(journal);
+			const auto slot = setRecord(journalId, score);
+			const auto found = ids.find(journalId);
+			if (slot != RECORD_COUNT && found != ids.end()) {
+				_installed[slot] = 1;
+				found->second->setHighScore(static_cast<int>(score));
+			}
+		}
+
+		log<Dbg::INFO>(_platform, "scores", [&] {return "read " + std::to_string(_count) + " scores";});
+		return true;
+	}
+
+	bool ScoreDb::set(const LevelFactory& level) {
+		const auto score = static_cast<uint32_t>(std::clamp(level.getHighScore(), 0, static_cast<int>(MAX_SCORE)));
+		const auto slot = setRecord(getId(level), score);
+		if (slot != RECORD_COUNT) {
+			_installed[slot] = 1;
+			_stalled = false;
+			return true;
+		}
+
+		_platform.message(Dbg::WARN, "scores", "score database is full, " + level.getName() + " is not saved");
+		return false;
+	}
+
+	bool ScoreDb::step() {
+		if (isSaved()) return true;
+
+		// Where every write rewrites the whole save, it's written once with all that changed.
+		// The journal can't help there, a whole save that is cut short is never half old, half new.
+		if (!_platform.writesSaveBlocks()) {
+			log<Dbg::INFO>(_platform, "scores", [] {return "writing the whole save";});
+			if (!write(0, _save.size())) return false;
+			_dirty = 0;
+			_journal = 0;
+			return true;
+		}
+
+		// Lowest block first, so the header of a new save goes before its records
+		size_t block = 0;
+		while (!(_dirty >> block & 1)) block++;
+
+		// The journal can only hold one record, it's written before the record's own
+		// block and not touched again until that is done
+		const auto* record = &_save[block * RECORD_SIZE];
+		if (block != 0 && block != JOURNAL_BLOCK && getRecordId(record) != 0 && _journal != block) {
+			std::copy(record, record + RECORD_SIZE, &_save[JOURNAL_BLOCK * RECORD_SIZE]);
+			if (!writeBlock(JOURNAL_BLOCK)) return false;
+			_journal = block;
+			return true;
+		}
+
+		if (!writeBlock(block)) return false;
+		_dirty &= ~(uint64_t{1} << block);
+		if (_journal == block) _journal = 0;
+		return true;
+	}
+
+	bool ScoreDb::save() {
+		while (!isSaved()) {
+			if (!step()) return false;
+		}
+
+		return true;
+	}
+
+	bool ScoreDb::writeBlock(const size_t block) {
+		log<Dbg::INFO>(_platform, "scores", [&] {return "writing block " + std::to_string(block);});
+		return write(block * RECORD_SIZE, RECORD_SIZE);
+	}
+
+	bool ScoreDb::write(const size_t offset, const size_t size) {
+		if (_platform.writeSave(&_save[offset], offset, size)) return true;
+		_platform.message(Dbg::WARN, "scores", "writing unsuccessful");
+		_stalled = true;
+		return false;
+	}
+
+	void ScoreDb::format() {
+		_save.assign(SAVE_SIZE, 0);
+		_installed.assign(RECORD_COUNT, 0);
+		std::memcpy(_save.data(), SCORE_HEADER, MAGIC_SIZE);
+		_save[MAGIC_SIZE] = VERSION;
+		_save[MAGIC_SIZE + 1] = RECORD_SIZE;
+		_save[CHECKED_SIZE] = getCheck(_save.data());
+		_count = 0;
+	}
+
+	bool ScoreDb::readLegacy(const uint8_t* data, const size_t size) {
+		// Numbers were written in the byte order of the machine, strings as a length and the bytes.
+		// The old writer didn't check for the end of the save, so neither can be trusted.
+		auto offset = std::strlen(LEGACY_HEADER);
+		const auto read32 = [&](uint32_t& num) {
+			if (size - offset < sizeof(num)) return false;
+			std::memcpy(&num, data + offset, sizeof(num));
+			offset += sizeof(num);
+			return true;
+		};
+
+		const auto readString = [&](std::string_view& str) {
+			uint32_t length = 0;
+			if (!read32(length) || length > size - offset) return false;
+			str = std::string_view(reinterpret_cast<const char*>(data + offset), length);
+			offset += length;
+			return true;
+		};
+
+		uint32_t count = 0;
+		if (!read32(count)) return false;
+		for (uint32_t i = 0; i < count; i++) {
+			std::string_view name, difficulty, mode, creator;
+			uint32_t score = 0;
+			if (!readString(name) || !readString(difficulty) || !readString(mode) || !readString(creator) || !read32(score)) return false;
+			if (score > 0) setRecord(getId(name, difficulty, mode, creator), std::min(score, MAX_SCORE));
+		}
+
+		return true;
+	}
+
+	size_t ScoreDb::setRecord(const uint32_t id, const uint32_t score) {
+		const auto slot = findSlot(id);
+		if (slot == RECORD_COUNT) return slot;
+
+		auto* record = &_save[(slot + 1) * RECORD_SIZE];
+		const auto previous = getRecordId(record);
+		if (previous == id && getRecordScore(record) >= score) return slot;
+		if (previous == 0) _count++;
+
+		record[0] = static_cast<uint8_t>(id);
+		record[1] = static_cast<uint8_t>(id >> 8);
+		record[2] = static_cast<uint8_t>(id >> 16);
+		record[3] = static_cast<uint8_t>(id >> 24);
+		record[4] = static_cast<uint8_t>(score);
+		record[5] = static_cast<uint8_t>(score >> 8);
+		record[6] = static_cast<uint8_t>(score >> 16);
+		record[CHECKED_SIZE] = getCheck(record);
+		_dirty |= uint64_t{1} << (slot + 1);
+		if (_journal == slot + 1) _journal = 0; // Holds what was there before
+		return slot;
+	}
+
+	size_t ScoreDb::findSlot(const uint32_t id) const {
+		// The level's own record, else an empty one, else one of a level that isn't installed
+		auto empty = RECORD_COUNT;
+		auto other = RECORD_COUNT;
+		for (size_t slot = 0; slot < RECORD_COUNT; slot++) {
+			const auto recordId = getRecordId(&_save[(slot + 1) * RECORD_SIZE]);
+			if (recordId == id) return slot;
+			if (recordId == 0 && empty == RECORD_COUNT) empty = slot;
+			if (recordId != 0 && !_installed[slot] && other == RECORD_COUNT) other = slot;
+		}
+
+		return empty != RECORD_COUNT ? empty : other;
+	}
+}
@@ -0,0 +1,99 @@
+#ifndef SUPER_HAXAGON_SCORE_DB_HPP
+#define SUPER_HAXAGON_SCORE_DB_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace SuperHaxagon {
+	class LevelFactory;
+	class Platform;
+
+	/**
+	 * The high scores as they are in the save. A header block, then one 8 byte
+	 * record per level: the level's id, its score and a check byte. Records
+	 * are found by id, not by where they are, so scores of levels that aren't
+	 * installed right now are kept until they are again. The last block is a
+	 * copy of the record written last, so one cut short can be put back.
+	 */
+	class ScoreDb {
+	public:
+		static const char* SCORE_HEADER;
+		static const char* LEGACY_HEADER;
+		static constexpr uint8_t VERSION = 1;
+
+		// The whole save (the EEPROM file on the N64), and its blocks
+		static constexpr size_t SAVE_SIZE = 500;
+		static constexpr size_t RECORD_SIZE = 8;
+		static constexpr size_t RECORD_COUNT = SAVE_SIZE / RECORD_SIZE - 2;
+		static constexpr size_t JOURNAL_BLOCK = RECORD_COUNT + 1;
+
+		// Scores are frames, this is over 77 hours
+		static constexpr uint32_t MAX_SCORE = 0xFFFFFF;
+
+		explicit ScoreDb(Platform& platform);
+
+		/**
+		 * A stable hash of the name, difficulty, mode and creator of a level.
+		 * Saved scores are found by it, so it can never change. Never 0.
+		 */
+		static uint32_t getId(std::string_view name, std::string_view difficulty, std::string_view mode, std::string_view creator);
+		static uint32_t getId(const LevelFactory& level);
+
+		/**
+		 * Reads the save and gives each level its score in one pass over the
+		 * records. A save in the old format is converted. Returns false if it
+		 * could not be read, then every level starts without a score.
+		 */
+		bool read(const std::vector<std::unique_ptr<LevelFactory>>& levels);
+
+		/**
+		 * Puts the high score of a level in the save, if it's higher than
+		 * the one there. Only marks its block to be written. Returns false
+		 * if it's full.
+		 */
+		bool set(const LevelFactory& level);
+
+		/**
+		 * Writes one block that changed, so a frame never waits on more than
+		 * one EEPROM write. A record goes to the journal block first, then to
+		 * its own. Where the platform can only write the whole save, every
+		 * change goes in one write instead. Returns false if the write failed,
+		 * then nothing more is tried until a score changes again.
+		 */
+		bool step();
+
+		/**
+		 * Writes every block that is left
+		 */
+		bool save();
+
+		bool isSaved() const {return !_dirty || _stalled;}
+
+		size_t getCount() const {return _count;}
+
+	private:
+		void format();
+		bool readLegacy(const uint8_t* data, size_t size);
+		size_t setRecord(uint32_t id, uint32_t score);
+		size_t findSlot(uint32_t id) const;
+		bool writeBlock(size_t block);
+		bool write(size_t offset, size_t size);
+
+		Platform& _platform;
+
+		// The save as it is written, and which records are for levels that are installed
+		std::vector<uint8_t> _save;
+		std::vector<uint8_t> _installed;
+		size_t _count = 0;
+
+		// A bit for every block that differs from the save, and the block the journal holds a copy of
+		uint64_t _dirty = 0;
+		size_t _journal = 0;
+		bool _stalled = false;
+	};
+}
+
+#endif //SUPER_HAXAGON_SCORE_DB_HPP
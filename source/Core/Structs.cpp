@@ -1,74 +1,13 @@
 #include "Core/Structs.hpp"
 
-#include "Driver/Platform.hpp"
-
+#include <algorithm>
 #include <cmath>
-#include <iomanip>
-#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <string>
 
-#include <libdragon.h>
-
 namespace SuperHaxagon {
-
-
-	// Byte swap unsigned short
-	uint16_t byteswap_uint16( uint16_t val ) 
-	{
-		return (val << 8) | (val >> 8 );
-	}
-
-	// Byte swap short
-	int16_t byteswap_int16( int16_t val ) 
-	{
-		return (val << 8) | ((val >> 8) & 0xFF);
-	}
-
-	// Byte swap unsigned int
-	uint32_t byteswap_uint32( uint32_t val )
-	{
-		val = ((val << 8) & 0xFF00FF00 ) | ((val >> 8) & 0xFF00FF ); 
-		return (val << 16) | (val >> 16);
-	}
-
-	// Byte swap int
-	int32_t byteswap_int32( int32_t val )
-	{
-		val = ((val << 8) & 0xFF00FF00) | ((val >> 8) & 0xFF00FF ); 
-		return (val << 16) | ((val >> 16) & 0xFFFF);
-	}
-
-	int64_t byteswap_int64( int64_t val )
-	{
-		val = ((val << 8) & 0xFF00FF00FF00FF00ULL ) | ((val >> 8) & 0x00FF00FF00FF00FFULL );
-		val = ((val << 16) & 0xFFFF0000FFFF0000ULL ) | ((val >> 16) & 0x0000FFFF0000FFFFULL );
-		return (val << 32) | ((val >> 32) & 0xFFFFFFFFULL);
-	}
-
-	uint64_t byteswap_uint64( uint64_t val )
-	{
-		val = ((val << 8) & 0xFF00FF00FF00FF00ULL ) | ((val >> 8) & 0x00FF00FF00FF00FFULL );
-		val = ((val << 16) & 0xFFFF0000FFFF0000ULL ) | ((val >> 16) & 0x0000FFFF0000FFFFULL );
-		return (val << 32) | (val >> 32);
-	}
-
-	float byteswap_float( const float inFloat )
-	{
-		float retVal;
-		char *floatToConvert = ( char* ) & inFloat;
-		char *returnFloat = ( char* ) & retVal;
-
-		// swap the bytes into a temporary buffer
-		returnFloat[0] = floatToConvert[3];
-		returnFloat[1] = floatToConvert[2];
-		returnFloat[2] = floatToConvert[1];
-		returnFloat[3] = floatToConvert[0];
-
-		return retVal;
-	}
-
-
-
 	uint8_t clamp(const float v) {
 		if (v < 0) return 0;
 		if (v > 255) return 255;
@@ -120,16 +59,12 @@ namespace SuperHaxagon {
 	}
 
 	std::string getTime(const float score) {
-		std::stringstream buffer;
+		// Short enough to fit in std::string's small buffer, so this never allocates
+		char buffer[16];
 		const auto scoreInt = static_cast<int>(score / 60.0f);
-		const auto decimalPart = static_cast<int>((score / 60.0f - scoreInt) * 100.0f);
-		buffer << std::fixed << std::setfill('0')
-			<< std::setprecision(3) << std::setw(3)
-			<< scoreInt
-			<< "."
-			<< std::setprecision(2) << std::setw(2)
-			<< decimalPart;
-		return buffer.str();
+		const auto decimalPart = static_cast<int>((score / 60.0f - static_cast<float>(scoreInt)) * 100.0f);
+		snprintf(buffer, sizeof(buffer), "%03d.%02d", scoreInt, decimalPart);
+		return buffer;
 	}
 
 	float getPulse(float frame, const float range, const float start) {
@@ -159,84 +94,59 @@ namespace SuperHaxagon {
 		return read.get() == str;
 	}
 
-	int32_t read32(std::istream& stream, const int32_t min, const int32_t max, Platform& platform, const std::string& noun) {
-		int32_t num;
-		stream.read(reinterpret_cast<char*>(&num), sizeof(num));
+	std::vector<uint8_t> readAll(std::istream& stream) {
+		static constexpr size_t FIRST_CHUNK = 4096;
+		static constexpr size_t MAX_FIRST_READ = 1024 * 1024;
 
-		num = byteswap_int32(num);
-
-		if (num < min) {
-			num = min;
-			platform.message(Dbg::WARN, "int", noun + " is too small (" + std::to_string(num) + "), but continuing anyway.");
+		// A compressed stream's end is what its header claims, so it's not trusted past a point
+		size_t expected = 0;
+		const auto start = stream.tellg();
+		if (start >= 0 && stream.seekg(0, std::ios::end)) {
+			const auto end = stream.tellg();
+			if (end > start) expected = static_cast<size_t>(end - start);
 		}
 
-		if (num > max) {
-			num = max;
-			platform.message(Dbg::WARN, "int", noun + " is too large (" + std::to_string(num) + "), but continuing anyway.");
+		stream.clear();
+		if (start >= 0) stream.seekg(start);
+
+		std::vector<uint8_t> data;
+		data.reserve(std::clamp(expected, FIRST_CHUNK, MAX_FIRST_READ));
+		while (stream) {
+			// Full, but it may have ended right there, which is most files whose size was known
+			if (data.size() == data.capacity()) {
+				if (stream.peek() == std::istream::traits_type::eof()) break;
+				data.reserve(data.capacity() * 2);
+			}
+
+			const auto have = data.size();
+			data.resize(data.capacity());
+			stream.read(reinterpret_cast<char*>(data.data() + have), static_cast<std::streamsize>(data.size() - have));
+			data.resize(have + static_cast<size_t>(stream.gcount()));
 		}
-		
 
-		return num;
+		if (data.size() < data.capacity() / 2) data.shrink_to_fit();
+		return data;
 	}
 
-	int32_t read32_noswap(std::istream& stream, const int32_t min, const int32_t max, Platform& platform, const std::string& noun) {
-		int32_t num;
-		stream.read(reinterpret_cast<char*>(&num), sizeof(num));
-
-		if (num < min) {
-			num = min;
-			platform.message(Dbg::WARN, "int", noun + " is too small (" + std::to_string(num) + "), but continuing anyway.");
-		}
+	uint64_t hashBytes(const void* data, const size_t size) {
+		static constexpr uint64_t PRIME = 0x100000001B3;
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		uint64_t hash = 0xCBF29CE484222325 ^ size;
 
-		if (num > max) {
-			num = max;
-			platform.message(Dbg::WARN, "int", noun + " is too large (" + std::to_string(num) + "), but continuing anyway.");
+		// FNV-1a, but eight bytes per step. The shift folds the high bits
+		// (where the multiply pushes everything) back down into the low ones.
+		size_t i = 0;
+		for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+			uint64_t word;
+			std::memcpy(&word, bytes + i, sizeof(word));
+			hash = (hash ^ word) * PRIME;
+			hash ^= hash >> 32;
 		}
-		
-
-		return num;
-	}
-
-	int16_t read16(std::istream& stream) {
-		int16_t num;
-		stream.read(reinterpret_cast<char*>(&num), sizeof(num));
-		num = byteswap_int16(num);
-		return num;
-	}
-
-	float readFloat(std::istream& stream) {
-		float num;
-		stream.read(reinterpret_cast<char*>(&num), sizeof(num));
-		num = byteswap_float(num);
-		return num;
-	}
 
-	Color readColor(std::istream& stream) {
-		Color color{};
-		stream.read(reinterpret_cast<char*>(&color.r), sizeof(color.r));
-		stream.read(reinterpret_cast<char*>(&color.g), sizeof(color.g));
-		stream.read(reinterpret_cast<char*>(&color.b), sizeof(color.b));
-		color.a = 0xFF;
-		return color;
+		for (; i < size; i++) hash = (hash ^ bytes[i]) * PRIME;
+		return hash;
 	}
 
-	std::string readString(std::istream& stream, Platform& platform, const std::string& noun) {
-		uint32_t length = read32(stream, 1, 300, platform, noun + " string");
-		const auto read = std::make_unique<char[]>(length + 1);
-		stream.read(read.get(), length);
-		read[length] = '\0';
-		return std::string(read.get());
-	}	
-
-	std::string readString_byteswap(std::istream& stream, Platform& platform, const std::string& noun) {
-		int32_t length = read32(stream, 1, 300, platform, noun + " string");
-		byteswap_int32(length);
-		const auto read = std::make_unique<char[]>(length + 1);
-		stream.read(read.get(), length);
-		read[length] = '\0';
-		return std::string(read.get());
-	}	
-
 	void writeString(std::ostream& stream, const std::string& str) {
 		auto len = static_cast<uint32_t>(str.length());
 		stream.write(reinterpret_cast<char*>(&len), sizeof(len));
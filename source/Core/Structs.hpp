@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <fstream>
 #include <string>
+#include <vector>
 
 namespace SuperHaxagon {
 	class Platform;
@@ -114,31 +115,18 @@ namespace SuperHaxagon {
 	bool readCompare(std::istream& stream, const std::string& str);
 
 	/**
-	 * Reads an integer from a file advancing its internal pointer
+	 * Reads everything left in a stream into memory. Where the stream says it
+	 * ends is only used to size the first read, the buffer grows with what is
+	 * actually there.
 	 */
-	int32_t read32(std::istream& stream, int32_t min, int32_t max, Platform& platform, const std::string& noun);
-	int32_t read32_noswap(std::istream& stream, const int32_t min, const int32_t max, Platform& platform, const std::string& noun);
-	/**
-	 * Reads a short from a file advancing its internal pointer
-	 */
-	int16_t read16(std::istream& stream);
-
-	/**
-	 * Read a float from a file advancing its internal pointer
-	 */
-	float readFloat(std::istream& stream);
-
-	/**
-	 * Reads a color from a file advancing its internal pointer
-	 */
-	Color readColor(std::istream& stream);
+	std::vector<uint8_t> readAll(std::istream& stream);
 
 	/**
-	 * Reads a string from the binary file
+	 * 64 bit hash, for recognising identical data without comparing it.
+	 * Depends on the machine's byte order, so only keep it on the machine that made it.
 	 */
-	std::string readString(std::istream& stream, Platform& platform, const std::string& noun);
+	uint64_t hashBytes(const void* data, size_t size);
 
-	std::string readString_byteswap(std::istream& stream, Platform& platform, const std::string& noun);
 	/**
 	 * Writes a string with a length to a binary file
 	 */
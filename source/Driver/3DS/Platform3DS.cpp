@@ -2,6 +2,7 @@
 
 #include "Wav3DS.hpp"
 #include "Core/Configuration.hpp"
+#include "Core/Parallel.hpp"
 #include "Core/Structs.hpp"
 #include "Core/Twist.hpp"
 #include "Driver/Font.hpp"
@@ -262,6 +263,8 @@ namespace SuperHaxagon {
 	}
 
 	void Platform::message(const Dbg dbg, const std::string& where, const std::string& message) const {
+		if (queueMessage(dbg, where, message)) return;
+
 		std::string format;
 		if (dbg == Dbg::INFO) {
 			format = "[3ds:info] ";
@@ -0,0 +1,39 @@
+#include "Driver/Platform.hpp"
+
+#include "Core/Structs.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SuperHaxagon {
+	bool Platform::mapFile(const std::string& partial, const Location location, FileView& view) const {
+#if defined(__unix__) || defined(__APPLE__)
+		const auto fd = ::open(getPath(partial, location).c_str(), O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat info{};
+		const auto size = fstat(fd, &info) == 0 && S_ISREG(info.st_mode) ? static_cast<size_t>(info.st_size) : 0;
+		auto* mapped = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+		::close(fd);
+		if (mapped != MAP_FAILED) {
+			// Unmapped when the last thing pointing into the file lets go of it
+			const std::shared_ptr<const void> owner(mapped, [size](const void* data) {
+				munmap(const_cast<void*>(data), size);
+			});
+
+			view = {static_cast<const uint8_t*>(mapped), size, owner};
+			return true;
+		}
+#endif
+
+		// Can't be mapped (or it's empty), so one bulk read instead
+		auto file = openFile(partial, location);
+		if (!file || !*file) return false;
+		view = std::make_shared<const std::vector<uint8_t>>(readAll(*file));
+		return true;
+	}
+}
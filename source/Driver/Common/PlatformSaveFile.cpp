@@ -0,0 +1,33 @@
+#include "Driver/Platform.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace SuperHaxagon {
+	// Stands in for the N64's EEPROM: a save that's shorter than asked for
+	// reads as zeros past its end, the same as a wiped EEPROM does
+	bool Platform::readSave(uint8_t* data, const size_t size) const {
+		FileView file;
+		if (!mapFile("/scores.db", Location::USER, file)) return false;
+		const auto read = std::min(size, file.size);
+		std::memcpy(data, file.data, read);
+		std::memset(data + read, 0, size - read);
+		return true;
+	}
+
+	bool Platform::writeSave(const uint8_t* data, const size_t offset, const size_t size) const {
+		// Only the bytes written change, the same as EEPROM blocks
+		const auto path = getPath("/scores.db", Location::USER);
+		std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+		if (!file) file.open(path, std::ios::out | std::ios::binary);
+		if (!file) return false;
+		file.seekp(static_cast<std::streamoff>(offset));
+		file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+		return static_cast<bool>(file);
+	}
+
+	bool Platform::writesSaveBlocks() const {
+		return true;
+	}
+}
@@ -1,7 +1,8 @@
 #include "Driver/Platform.hpp"
 
+#include <algorithm>
 #include <filesystem>
-#include <libdragon.h>
+#include <fstream>
 
 namespace SuperHaxagon {
 	std::vector<std::pair<Location, std::string>> Platform::loadUserLevels() {
@@ -11,12 +12,38 @@ namespace SuperHaxagon {
 		if (std::filesystem::exists(dir)) {
 			auto files = std::filesystem::directory_iterator(dir);
 			for (const auto& file : files) {
-				if (file.path().extension() != ".haxagon") continue;
+				// The built-in pack is loaded first, on its own
+				if (file.path().extension() != ".haxagon" || file.path().filename() == "levels.haxagon") continue;
 				this->message(Dbg::INFO, "load", "found " + file.path().string());
 				levels.emplace_back(Location::ROM, "/" + file.path().filename().string());
 			}
 		}
 
+		// The directory order is up to the filesystem, level indices shouldn't be
+		std::sort(levels.begin(), levels.end());
 		return levels;
 	}
+
+	std::unique_ptr<std::ostream> Platform::writeFile(const std::string& partial, const Location location) const {
+		const std::filesystem::path path = getPath(partial, location);
+		std::error_code error;
+		std::filesystem::create_directories(path.parent_path(), error);
+		auto file = std::make_unique<std::ofstream>(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!*file) return nullptr;
+		return file;
+	}
+
+	bool Platform::getFileStamp(const std::string& partial, const Location location, FileStamp& stamp) const {
+		const std::filesystem::path path = getPath(partial, location);
+		std::error_code error;
+
+		// Directories only have a time, it changes when files are added, removed or renamed
+		const auto size = std::filesystem::is_directory(path, error) ? 0 : std::filesystem::file_size(path, error);
+		if (error) return false;
+		const auto modified = std::filesystem::last_write_time(path, error);
+		if (error) return false;
+		stamp.size = size;
+		stamp.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+		return true;
+	}
 }
\ No newline at end of file
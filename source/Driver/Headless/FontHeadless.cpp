@@ -0,0 +1,37 @@
+#include "Driver/Font.hpp"
+
+#include "Core/Structs.hpp"
+
+#include <string>
+
+namespace SuperHaxagon {
+	struct Font::FontData {
+		explicit FontData(const int size) : size(static_cast<float>(size)) {}
+
+		float size;
+		float scale = 1.0f;
+	};
+
+	std::unique_ptr<Font> createFont(const int size) {
+		return std::make_unique<Font>(std::make_unique<Font::FontData>(size));
+	}
+
+	Font::Font(std::unique_ptr<Font::FontData> data) : _data(std::move(data)) {}
+
+	Font::~Font() = default;
+
+	void Font::setScale(const float scale) {
+		_data->scale = scale;
+	}
+
+	float Font::getHeight() const {
+		return _data->size * _data->scale;
+	}
+
+	float Font::getWidth(const std::string& str) const {
+		// Roughly the advance of the real font so layouts stay plausible
+		return static_cast<float>(str.size()) * _data->size * _data->scale * 0.6f;
+	}
+
+	void Font::draw(const Color&, const Point&, Alignment, const std::string&) const {}
+}
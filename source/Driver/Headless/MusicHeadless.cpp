@@ -0,0 +1,42 @@
+#include "Driver/Music.hpp"
+
+namespace SuperHaxagon {
+	struct Music::MusicData {
+		// Advances one frame per update so metadata fires deterministically
+		float time = 0;
+		bool loop = false;
+		bool playing = false;
+	};
+
+	std::unique_ptr<Music> createMusic() {
+		return std::make_unique<Music>(std::make_unique<Music::MusicData>());
+	}
+
+	Music::Music(std::unique_ptr<Music::MusicData> data) : _data(std::move(data)) {}
+
+	Music::~Music() = default;
+
+	void Music::update() const {
+		if (_data->playing) _data->time += 1.0f / 60.0f;
+	}
+
+	void Music::setLoop(const bool loop) const {
+		_data->loop = loop;
+	}
+
+	void Music::play() const {
+		_data->playing = true;
+	}
+
+	void Music::pause() const {
+		_data->playing = false;
+	}
+
+	bool Music::isDone() const {
+		return false;
+	}
+
+	float Music::getTime() const {
+		return _data->time;
+	}
+}
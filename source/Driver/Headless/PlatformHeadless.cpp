@@ -0,0 +1,144 @@
+#include "Driver/Platform.hpp"
+
+#include "Core/Parallel.hpp"
+#include "Core/Structs.hpp"
+#include "Core/Twist.hpp"
+#include "Driver/Font.hpp"
+#include "Driver/Music.hpp"
+#include "Driver/Sound.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace SuperHaxagon {
+	std::unique_ptr<Font> createFont(int size);
+	std::unique_ptr<Music> createMusic();
+	std::unique_ptr<Sound> createSound(std::vector<uint8_t> samples);
+
+	/**
+	 * A driver without a window, audio or input so the core can run on a
+	 * plain host (benchmarks, tools). Paths come from HAXAGON_ROM and HAXAGON_USER.
+	 */
+	struct Platform::PlatformData {
+		std::string rom;
+		std::string user;
+		uint32_t polys = 0;
+		bool quiet = false;
+	};
+
+	static std::string getEnv(const char* name, const char* fallback) {
+		const auto* value = std::getenv(name);
+		return value ? value : fallback;
+	}
+
+	Platform::Platform() : _plat(std::make_unique<PlatformData>()) {
+		_plat->rom = getEnv("HAXAGON_ROM", "assets");
+		_plat->user = getEnv("HAXAGON_USER", "./user");
+		_plat->quiet = std::getenv("HAXAGON_QUIET") != nullptr;
+		mkdir(_plat->user.c_str(), 0755);
+	}
+
+	Platform::~Platform() = default;
+
+	bool Platform::loop() {
+		return true;
+	}
+
+	float Platform::getDilation() const {
+		// Every frame is exactly 1/60th of a second so runs are reproducible
+		return 1.0f;
+	}
+
+	std::string Platform::getPath(const std::string& partial, const Location location) const {
+		switch (location) {
+		case Location::ROM:
+			return _plat->rom + partial;
+		case Location::USER:
+			return _plat->user + partial;
+		}
+
+		return "";
+	}
+
+	std::unique_ptr<std::istream> Platform::openFile(const std::string& partial, const Location location) const {
+		return std::make_unique<std::ifstream>(getPath(partial, location), std::ios::in | std::ios::binary);
+	}
+
+	std::unique_ptr<Font> Platform::loadFont(const int size) const {
+		return createFont(size);
+	}
+
+	std::unique_ptr<Sound> Platform::loadSound(const std::string& base) const {
+		// Read whole, the way the other drivers load a sound
+		auto file = openFile(base + ".wav", Location::ROM);
+		if (!*file) return nullptr;
+		return createSound(readAll(*file));
+	}
+
+	std::unique_ptr<Music> Platform::loadMusic(const std::string&, Location) const {
+		return createMusic();
+	}
+
+	std::string Platform::getButtonName(const Buttons&) {
+		return "?";
+	}
+
+	Buttons Platform::getPressed() const {
+		return {};
+	}
+
+	Point Platform::getScreenDim() const {
+		return {640, 360};
+	}
+
+	void Platform::screenBegin() const {
+		_plat->polys = 0;
+	}
+
+	void Platform::screenSwap() {}
+
+	void Platform::screenFinalize() const {}
+
+	void Platform::drawPoly(const Color&, const std::vector<Point>& points) const {
+		_plat->polys += static_cast<uint32_t>(points.size());
+	}
+
+	std::unique_ptr<Twist> Platform::getTwister() {
+		// Fixed seed, the same run twice should do the same work twice
+		return std::make_unique<Twist>(std::make_unique<std::seed_seq>(std::initializer_list<uint32_t>{0x48415841}));
+	}
+
+	void Platform::shutdown() {}
+
+	void Platform::message(const Dbg dbg, const std::string& where, const std::string& message) const {
+		if (queueMessage(dbg, where, message)) return;
+
+		if (dbg == Dbg::INFO) {
+			if (_plat->quiet) return;
+			std::cerr << "[headless:info] " + where + ": " + message << std::endl;
+		} else if (dbg == Dbg::WARN) {
+			std::cerr << "[headless:warn] " + where + ": " + message << std::endl;
+		} else if (dbg == Dbg::FATAL) {
+			std::cerr << "[headless:fatal] " + where + ": " + message << std::endl;
+		}
+	}
+
+	Supports Platform::supports() {
+		return Supports::SHADOWS;
+	}
+}
+
+static double now() {
+	const auto time = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration<double>(time).count();
+}
+
+double getCurrentTime() {
+	return now();
+}
+
+void addRumble(double) {}
+
+void updateRumble(double) {}
@@ -0,0 +1,23 @@
+#include "Driver/Sound.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace SuperHaxagon {
+	struct Sound::SoundData {
+		// Kept in memory like a real driver would, so loading costs about the same
+		std::vector<uint8_t> samples;
+	};
+
+	std::unique_ptr<Sound> createSound(std::vector<uint8_t> samples) {
+		auto data = std::make_unique<Sound::SoundData>();
+		data->samples = std::move(samples);
+		return std::make_unique<Sound>(std::move(data));
+	}
+
+	Sound::Sound(std::unique_ptr<SoundData> data) : _data(std::move(data)) {}
+
+	Sound::~Sound() = default;
+
+	void Sound::play() const {}
+}
@@ -45,13 +45,22 @@ namespace SuperHaxagon {
 		else _data->textScale = false;
 	}
 
+	// The font has no glyphs for these, so they get swapped for look-alikes.
+	// Only copies the string when it actually contains one of them.
+	static const char* replaceMissing(const std::string& str, std::string& scratch) {
+		if (str.find_first_of("$^") == std::string::npos) return str.c_str();
+		scratch = str;
+		std::replace( scratch.begin(), scratch.end(), '$', 'S');
+		std::replace( scratch.begin(), scratch.end(), '^', 'v');
+		return scratch.c_str();
+	}
+
 	float Font::getWidth(const std::string& str) const {
-		std::string str_dynamic = str;
+		std::string scratch;
+		const auto* text = replaceMissing(str, scratch);
 		float width;
-		int len = str_dynamic.length();
-		std::replace( str_dynamic.begin(), str_dynamic.end(), '$', 'S');
-		std::replace( str_dynamic.begin(), str_dynamic.end(), '^', 'v');
-		rdpq_paragraph_t * paragraph = rdpq_paragraph_build(NULL, _data->size > 26? FONT_TEXT_LARGE : FONT_TEXT_SMALL, str_dynamic.c_str(), &len);
+		int len = str.length();
+		rdpq_paragraph_t * paragraph = rdpq_paragraph_build(NULL, _data->size > 26? FONT_TEXT_LARGE : FONT_TEXT_SMALL, text, &len);
 		width = paragraph->bbox.x1 - paragraph->bbox.x0;
 		rdpq_paragraph_free(paragraph);
 		return width;
@@ -62,24 +71,23 @@ namespace SuperHaxagon {
 	}
 
 	void Font::draw(const Color& color, const Point& position, const Alignment alignment, const std::string& str) const {
-		std::string str_dynamic = str;
-		std::replace( str_dynamic.begin(), str_dynamic.end(), '$', 'S');
-		std::replace( str_dynamic.begin(), str_dynamic.end(), '^', 'v');
+		std::string scratch;
+		const auto* text = replaceMissing(str, scratch);
 		rdpq_textparms_t parms = {0};
 		float xpos = position.x;
 		if (alignment == Alignment::LEFT) parms.align = ALIGN_LEFT;
 		if (alignment == Alignment::CENTER) {
 			parms.align = ALIGN_CENTER;
-			xpos -= getWidth(str_dynamic.c_str()) / 2.0f;
+			xpos -= getWidth(str) / 2.0f;
 		}
 		if (alignment == Alignment::RIGHT) {
 			parms.align = ALIGN_RIGHT;
-			xpos -= getWidth(str_dynamic.c_str());
+			xpos -= getWidth(str);
 		}
 		rdpq_fontstyle_t style = {0};
 		style.outline_color = RGBA32(0,0,0,255);
 		style.color = RGBA32(color.r, color.g, color.b, color.a);
 		rdpq_font_style(_data->font, 0, &style);
-		rdpq_text_print(&parms, _data->size > 26? FONT_TEXT_LARGE : FONT_TEXT_SMALL, xpos, position.y + _data->size, str_dynamic.c_str());
+		rdpq_text_print(&parms, _data->size > 26? FONT_TEXT_LARGE : FONT_TEXT_SMALL, xpos, position.y + _data->size, text);
 	}
 }
@@ -1,5 +1,9 @@
 #include "Driver/Platform.hpp"
 
+#include "Core/Archive.hpp"
+#include "Core/Memory.hpp"
+#include "Core/Parallel.hpp"
+#include "Core/ScoreDb.hpp"
 #include "Core/Structs.hpp"
 #include "Core/Twist.hpp"
 #include "Driver/Font.hpp"
@@ -9,6 +13,7 @@
 
 #include <libdragon.h>
 
+#include <algorithm>
 #include <array>
 #include <iostream>
 #include <sstream>
@@ -27,13 +32,53 @@ namespace SuperHaxagon {
 
 	extern void audioCallback(void*);
 
+	static const char* SAVE_PATH = "/scores.db";
+
+	// Seconds between looking for the largest free block while the memory overlay is up
+	static constexpr double LARGEST_FREE_INTERVAL = 1.0;
+
 	struct Platform::PlatformData {
+		// The small ROM files, read in one go at boot, then looked up in its index
+		FileView assetsFile;
+		std::unique_ptr<Archive> assets;
 
+		// The save as it should be in the EEPROM, and if its blocks can be written on their own
+		std::vector<uint8_t> save;
+		bool rawSave = false;
 		bool transpState = false;
 		bool debugConsole = false;
 		float _last = 0;
+
+		// The memory overlay's largest free block. Finding it takes a couple dozen
+		// mallocs, so it's done when Z is pressed and then once a second.
+		size_t largestFree = 0;
+		double largestAt = 0;
+		bool overlay = false;
 	};
 
+	/**
+	 * eepfs only writes whole files, so writeSave puts single blocks of the
+	 * save straight into the EEPROM where eepfs keeps /scores.db: right after
+	 * its signature block. eepfs doesn't promise that, so it's checked here.
+	 */
+	static bool checkSaveLayout(std::vector<uint8_t>& save) {
+		save.assign(ScoreDb::SAVE_SIZE, 0);
+		if (eepfs_read(SAVE_PATH, save.data(), save.size()) != EEPFS_ESUCCESS) return false;
+
+		std::vector<uint8_t> raw(save.size());
+		eeprom_read_bytes(raw.data(), EEPROM_BLOCK_SIZE, raw.size());
+		if (raw != save) return false;
+		if (std::any_of(save.begin(), save.end(), [](const uint8_t b) {return b != 0;})) return true;
+
+		// A blank save looks the same wherever it is, so a block is written where
+		// the file should start, read back through eepfs and then put back
+		static constexpr uint8_t PROBE[EEPROM_BLOCK_SIZE] = {'H', 'A', 'X', 'P', 'R', 'O', 'B', 'E'};
+		eeprom_write_bytes(PROBE, EEPROM_BLOCK_SIZE, sizeof(PROBE));
+		const auto read = eepfs_read(SAVE_PATH, raw.data(), raw.size()) == EEPFS_ESUCCESS;
+		eeprom_write_bytes(save.data(), EEPROM_BLOCK_SIZE, sizeof(PROBE));
+		return read && std::equal(PROBE, PROBE + sizeof(PROBE), raw.begin());
+	}
+
 	Platform::Platform() : _plat(std::make_unique<PlatformData>()) {
 		debug_init_isviewer();
 		debug_init_usblog();
@@ -55,7 +100,7 @@ namespace SuperHaxagon {
 		const eeprom_type_t eeprom_type = eeprom_present();
 		if(eeprom_type == EEPROM_4K){
 			const eepfs_entry_t eeprom_4k_files[] = {
-				{ "/scores.db", size_t(500)  },
+				{ SAVE_PATH, ScoreDb::SAVE_SIZE },
 			};
 		
 			debugf( "EEPROM Detected: 4 Kibit (64 blocks)\n" );
@@ -85,6 +130,12 @@ namespace SuperHaxagon {
 			debugf( "Wiping EEPROM...\n" );
 			eepfs_wipe();
 		}
+
+		if (eeprom_type == EEPROM_4K && result == EEPFS_ESUCCESS) {
+			_plat->rawSave = checkSaveLayout(_plat->save);
+			if (!_plat->rawSave) debugf( "Unexpected EEPROM layout, saving whole files\n" );
+		}
+
 		srand(getentropy32());
 		register_VI_handler((void(*)())rand);
 
@@ -93,6 +144,9 @@ namespace SuperHaxagon {
 		display_init(((resolution_t){.width = 640, .height = 360, .interlaced = INTERLACE_HALF, .aspect_ratio = 16.0 / 9.0}), DEPTH_16_BPP, 5, GAMMA_NONE, fastMode? FILTERS_DISABLED : FILTERS_RESAMPLE_ANTIALIAS_DEDITHER);
 		display_set_fps_limit(60);
 
+		if (mapFile("/assets.hxa", Location::ROM, _plat->assetsFile)) {
+			_plat->assets = std::make_unique<Archive>(_plat->assetsFile.data, _plat->assetsFile.size, *this, "assets.hxa");
+		}
 	}
 
 	Platform::~Platform() {
@@ -136,9 +190,66 @@ namespace SuperHaxagon {
 	}
 
 	std::unique_ptr<std::istream> Platform::openFile(const std::string& partial, const Location location) const {
+		if (location == Location::ROM && _plat->assets) {
+			auto file = _plat->assets->open(partial);
+			if (file) return file;
+		}
+
 		return std::make_unique<std::ifstream>(getPath(partial, location), std::ios::in | std::ios::binary);
 	}
 
+	bool Platform::mapFile(const std::string& partial, const Location location, FileView& view) const {
+		if (location == Location::USER) {
+			auto file = openFile(partial, location);
+			if (!file || !*file) return false;
+			view = std::make_shared<const std::vector<uint8_t>>(readAll(*file));
+			return true;
+		}
+
+		// Files in the asset archive are already in memory
+		if (_plat->assets) {
+			if (const auto* entry = _plat->assets->find(partial)) {
+				view = {_plat->assets->getBytes(*entry), entry->size, _plat->assetsFile.owner};
+				return true;
+			}
+		}
+
+		// The cartridge can't be read a byte at a time through a pointer, so the
+		// whole file is DMA'd into memory at once, no stdio buffering on the way
+		const auto handle = dfs_open(partial.c_str());
+		if (handle < 0) return false;
+
+		const auto size = std::max(dfs_size(handle), 0);
+		auto bytes = std::make_shared<std::vector<uint8_t>>(size);
+		const auto read = size > 0 ? dfs_read(bytes->data(), 1, size, handle) : 0;
+		dfs_close(handle);
+		if (read != size) return false;
+
+		view = {bytes->data(), bytes->size(), bytes};
+		return true;
+	}
+
+	bool Platform::readSave(uint8_t* data, const size_t size) const {
+		return eepfs_read(SAVE_PATH, data, size) == EEPFS_ESUCCESS;
+	}
+
+	bool Platform::writeSave(const uint8_t* data, const size_t offset, const size_t size) const {
+		if (eeprom_present() != EEPROM_4K || offset + size > _plat->save.size()) return false;
+		std::copy(data, data + size, _plat->save.begin() + static_cast<std::ptrdiff_t>(offset));
+
+		// Only the blocks that changed, if /scores.db was found where it was expected
+		if (_plat->rawSave) {
+			eeprom_write_bytes(data, EEPROM_BLOCK_SIZE + offset, size);
+			return true;
+		}
+
+		return eepfs_write(SAVE_PATH, _plat->save.data(), _plat->save.size()) == EEPFS_ESUCCESS;
+	}
+
+	bool Platform::writesSaveBlocks() const {
+		return _plat->rawSave;
+	}
+
 	std::unique_ptr<Font> Platform::loadFont(int size) const {
 		std::stringstream s;
 		s << "/fonts/bump-it-up-" << size << ".font64";
@@ -199,6 +310,26 @@ namespace SuperHaxagon {
 	void Platform::screenFinalize() const {
 		joypad_inputs_t stick = joypad_get_inputs(JOYPAD_PORT_1);
 		if(stick.btn.l || stick.btn.r) rdpq_text_printf(NULL, 1, 50,100, "FPS: %.2f", display_get_fps());
+		if(stick.btn.z) {
+			const auto now = getCurrentTime();
+			if (!_plat->overlay || now - _plat->largestAt >= LARGEST_FREE_INTERVAL) {
+				_plat->largestFree = Memory::getLargestFreeBlock();
+				_plat->largestAt = now;
+			}
+
+			// Memory overlay, current and peak KiB per subsystem
+			float y = 120;
+			for (auto i = MEM_TAG_FIRST; i != MEM_TAG_LAST; i++, y += 16) {
+				const auto tag = static_cast<MemTag>(i);
+				const auto& stats = Memory::getStats(tag);
+				rdpq_text_printf(NULL, 1, 50, y, "%s: %uK / %uK", Memory::getName(tag), static_cast<unsigned>(stats.current / 1024), static_cast<unsigned>(stats.peak / 1024));
+			}
+
+			rdpq_text_printf(NULL, 1, 50, y, "HEAP: %uK FREE: %uK", static_cast<unsigned>(Memory::getHeapUsed() / 1024), static_cast<unsigned>(Memory::getHeapFree() / 1024));
+			rdpq_text_printf(NULL, 1, 50, y + 16, "LARGEST: %uK", static_cast<unsigned>(_plat->largestFree / 1024));
+		}
+
+		_plat->overlay = stick.btn.z;
 		rdpq_detach_show();
 	}
 
@@ -245,6 +376,8 @@ namespace SuperHaxagon {
 	}
 
 	void Platform::message(const Dbg dbg, const std::string& where, const std::string& message) const {
+		if (queueMessage(dbg, where, message)) return;
+
 		std::string format;
 		if (dbg == Dbg::INFO) {
 			format = "[N64:INFO] ";
@@ -263,3 +396,19 @@ namespace SuperHaxagon {
 		return fastMode? Supports::NOTHING : Supports::SHADOWS;
 	}
 }
+
+float rumbleTime = 0;
+
+double getCurrentTime() {
+	// Microsecond resolution so the flight recorder can time individual phases
+	const auto ticks = timer_ticks();
+	return static_cast<double>(TICKS_TO_US(ticks)) / 1000000.0;
+}
+
+void addRumble(double time){
+	rumbleTime = getCurrentTime() + time;
+}
+
+void updateRumble(double dt){
+	joypad_set_rumble_active(JOYPAD_PORT_1, rumbleTime > getCurrentTime());
+}
@@ -1,88 +1,90 @@
 #include "MemoryFS.hpp"
 
-// This section SHOULD be code generated
-extern unsigned char romfs_levels_haxagon[];
-extern unsigned int romfs_levels_haxagon_len;
-
-extern unsigned char romfs_bgm_callMeKatla_txt[];
-extern unsigned int romfs_bgm_callMeKatla_txt_len;
-
-extern unsigned char romfs_bgm_captainCool_txt[];
-extern unsigned int romfs_bgm_captainCool_txt_len;
-
-extern unsigned char romfs_bgm_commandoSteve_txt[];
-extern unsigned int romfs_bgm_commandoSteve_txt_len;
-
-extern unsigned char romfs_bgm_drFinkelfracken_txt[];
-extern unsigned int romfs_bgm_drFinkelfracken_txt_len;
-
-extern unsigned char romfs_bgm_esiannoyamFoEzam_txt[];
-extern unsigned int romfs_bgm_esiannoyamFoEzam_txt_len;
-
-extern unsigned char romfs_bgm_jackRussel_txt[];
-extern unsigned int romfs_bgm_jackRussel_txt_len;
-
-extern unsigned char romfs_bgm_mazeOfMayonnaise_txt[];
-extern unsigned int romfs_bgm_mazeOfMayonnaise_txt_len;
-
-extern unsigned char romfs_bgm_screenSaver_txt[];
-extern unsigned int romfs_bgm_screenSaver_txt_len;
-// End section
+#include "Core/Archive.hpp"
+#include "Core/MemoryStream.hpp"
+#include "Driver/Platform.hpp"
+
+// Generated by haxar --cpp=romfs_archive from the assets the Nspire uses (make -C tools nspire).
+// Builds that still compile in one array per file link without it, see FILES.
+extern unsigned char romfs_archive[] __attribute__((weak));
+extern unsigned int romfs_archive_len __attribute__((weak));
+
+extern unsigned char romfs_levels_haxagon[] __attribute__((weak));
+extern unsigned int romfs_levels_haxagon_len __attribute__((weak));
+extern unsigned char romfs_bgm_callMeKatla_txt[] __attribute__((weak));
+extern unsigned int romfs_bgm_callMeKatla_txt_len __attribute__((weak));
+extern unsigned char romfs_bgm_captainCool_txt[] __attribute__((weak));
+extern unsigned int romfs_bgm_captainCool_txt_len __attribute__((weak));
+extern unsigned char romfs_bgm_commandoSteve_txt[] __attribute__((weak));
+extern unsigned int romfs_bgm_commandoSteve_txt_len __attribute__((weak));
+extern unsigned char romfs_bgm_drFinkelfracken_txt[] __attribute__((weak));
+extern unsigned int romfs_bgm_drFinkelfracken_txt_len __attribute__((weak));
+extern unsigned char romfs_bgm_esiannoyamFoEzam_txt[] __attribute__((weak));
+extern unsigned int romfs_bgm_esiannoyamFoEzam_txt_len __attribute__((weak));
+extern unsigned char romfs_bgm_jackRussel_txt[] __attribute__((weak));
+extern unsigned int romfs_bgm_jackRussel_txt_len __attribute__((weak));
+extern unsigned char romfs_bgm_mazeOfMayonnaise_txt[] __attribute__((weak));
+extern unsigned int romfs_bgm_mazeOfMayonnaise_txt_len __attribute__((weak));
+extern unsigned char romfs_bgm_screenSaver_txt[] __attribute__((weak));
+extern unsigned int romfs_bgm_screenSaver_txt_len __attribute__((weak));
 
 namespace SuperHaxagon {
-	struct MemoryBuffer : std::streambuf {
-		MemoryBuffer(unsigned char* base, const size_t size) {
-			auto* const p(reinterpret_cast<char*>(base));
-			this->setg(p, p, p + size);
-		}
+	struct MemoryFile {
+		const char* path;
+		const unsigned char* data;
+		const unsigned int* size;
 	};
 
-	struct MemoryStream final : virtual MemoryBuffer, std::istream {
-		MemoryStream(unsigned char* base, const size_t size) :
-			MemoryBuffer(base, size),
-			std::istream(static_cast<std::streambuf*>(this)) {
-		}
+	// The arrays older builds compile in, used only when there's no archive
+	static const MemoryFile FILES[] = {
+		{"/levels.haxagon", romfs_levels_haxagon, &romfs_levels_haxagon_len},
+		{"/bgm/callMeKatla.txt", romfs_bgm_callMeKatla_txt, &romfs_bgm_callMeKatla_txt_len},
+		{"/bgm/captainCool.txt", romfs_bgm_captainCool_txt, &romfs_bgm_captainCool_txt_len},
+		{"/bgm/commandoSteve.txt", romfs_bgm_commandoSteve_txt, &romfs_bgm_commandoSteve_txt_len},
+		{"/bgm/drFinkelfracken.txt", romfs_bgm_drFinkelfracken_txt, &romfs_bgm_drFinkelfracken_txt_len},
+		{"/bgm/esiannoyamFoEzam.txt", romfs_bgm_esiannoyamFoEzam_txt, &romfs_bgm_esiannoyamFoEzam_txt_len},
+		{"/bgm/jackRussel.txt", romfs_bgm_jackRussel_txt, &romfs_bgm_jackRussel_txt_len},
+		{"/bgm/mazeOfMayonnaise.txt", romfs_bgm_mazeOfMayonnaise_txt, &romfs_bgm_mazeOfMayonnaise_txt_len},
+		{"/bgm/screenSaver.txt", romfs_bgm_screenSaver_txt, &romfs_bgm_screenSaver_txt_len},
 	};
-	
-	std::unique_ptr<std::istream> MemoryFS::openFile(const std::string& partial) {
-		// This section SHOULD be code generated
-		if (partial == "/levels.haxagon") {
-			return std::make_unique<MemoryStream>(&romfs_levels_haxagon[0], romfs_levels_haxagon_len);
-		}
-
-		if (partial == "/bgm/callMeKatla.txt") {
-			return std::make_unique<MemoryStream>(&romfs_bgm_callMeKatla_txt[0], romfs_bgm_callMeKatla_txt_len);
-		}
-
-		if (partial == "/bgm/captainCool.txt") {
-			return std::make_unique<MemoryStream>(&romfs_bgm_captainCool_txt[0], romfs_bgm_captainCool_txt_len);
-		}
 
-		if (partial == "/bgm/commandoSteve.txt") {
-			return std::make_unique<MemoryStream>(&romfs_bgm_commandoSteve_txt[0], romfs_bgm_commandoSteve_txt_len);
+	/**
+	 * A file from the arrays of older builds, null if it isn't one of them
+	 */
+	static const MemoryFile* findFile(const std::string& partial) {
+		for (const auto& file : FILES) {
+			if (file.data && partial == file.path) return &file;
 		}
 
-		if (partial == "/bgm/drFinkelfracken.txt") {
-			return std::make_unique<MemoryStream>(&romfs_bgm_drFinkelfracken_txt[0], romfs_bgm_drFinkelfracken_txt_len);
-		}
+		return nullptr;
+	}
 
-		if (partial == "/bgm/esiannoyamFoEzam.txt") {
-			return std::make_unique<MemoryStream>(&romfs_bgm_esiannoyamFoEzam_txt[0], romfs_bgm_esiannoyamFoEzam_txt_len);
-		}
+	const Archive& MemoryFS::getArchive(const Platform& platform) {
+		static const Archive archive(&romfs_archive[0], romfs_archive_len, platform, "romfs");
+		return archive;
+	}
 
-		if (partial == "/bgm/jackRussel.txt") {
-			return std::make_unique<MemoryStream>(&romfs_bgm_jackRussel_txt[0], romfs_bgm_jackRussel_txt_len);
-		}
+	std::unique_ptr<std::istream> MemoryFS::openFile(const std::string& partial, const Platform& platform) {
+		if (romfs_archive) return getArchive(platform).open(partial);
 
-		if (partial == "/bgm/mazeOfMayonnaise.txt") {
-			return std::make_unique<MemoryStream>(&romfs_bgm_mazeOfMayonnaise_txt[0], romfs_bgm_mazeOfMayonnaise_txt_len);
-		}
+		const auto* file = findFile(partial);
+		if (!file) return nullptr;
+		return std::make_unique<MemoryStream>(file->data, *file->size);
+	}
 
-		if (partial == "/bgm/screenSaver.txt") {
-			return std::make_unique<MemoryStream>(&romfs_bgm_screenSaver_txt[0], romfs_bgm_screenSaver_txt_len);
+	bool MemoryFS::mapFile(const std::string& partial, const Platform& platform, FileView& view) {
+		// Compiled in, so it's there for good and nothing owns it
+		if (romfs_archive) {
+			const auto& archive = getArchive(platform);
+			const auto* entry = archive.find(partial);
+			if (!entry) return false;
+			view = {archive.getBytes(*entry), entry->size, nullptr};
+			return true;
 		}
-		// End section
 
-		return nullptr;
+		const auto* file = findFile(partial);
+		if (!file) return false;
+		view = {file->data, *file->size, nullptr};
+		return true;
 	}
 }
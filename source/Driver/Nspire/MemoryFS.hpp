@@ -6,9 +6,17 @@
 #include <memory>
 
 namespace SuperHaxagon {
+	class Archive;
+	class Platform;
+	struct FileView;
+
 	class MemoryFS {
 	public:
-		static std::unique_ptr<std::istream> openFile(const std::string& partial);
+		static std::unique_ptr<std::istream> openFile(const std::string& partial, const Platform& platform);
+		static bool mapFile(const std::string& partial, const Platform& platform, FileView& view);
+
+	private:
+		static const Archive& getArchive(const Platform& platform);
 	};
 }
 
@@ -4,6 +4,8 @@
 #include "MemoryFS.hpp"
 #include "Core/Twist.hpp"
 #include "Core/Metadata.hpp"
+#include "Core/Parallel.hpp"
+#include "Core/Structs.hpp"
 #include "Driver/Font.hpp"
 #include "Driver/Music.hpp"
 #include "Driver/Sound.hpp"
@@ -76,7 +78,16 @@ namespace SuperHaxagon {
 			return std::make_unique<std::ifstream>(getPath(partial, location), std::ios::in | std::ios::binary);
 		}
 
-		return MemoryFS::openFile(partial);
+		return MemoryFS::openFile(partial, *this);
+	}
+
+	bool Platform::mapFile(const std::string& partial, const Location location, FileView& view) const {
+		if (location == Location::ROM) return MemoryFS::mapFile(partial, *this, view);
+
+		auto file = openFile(partial, location);
+		if (!file || !*file) return false;
+		view = std::make_shared<const std::vector<uint8_t>>(readAll(*file));
+		return true;
 	}
 
 	std::unique_ptr<Font> Platform::loadFont(const int size) const {
@@ -89,7 +100,8 @@ namespace SuperHaxagon {
 	}
 
 	std::unique_ptr<Music> Platform::loadMusic(const std::string& base, const Location location) const {
-		Metadata metadata(openFile(base + ".txt", location));
+		const auto file = Metadata::map(*this, base, location);
+		Metadata metadata(file.data, file.size);
 		return createMusic(metadata.getMaxTime(), &_plat->bgmDelta);
 	}
 
@@ -103,6 +115,14 @@ namespace SuperHaxagon {
 		return levels;
 	}
 
+	std::unique_ptr<std::ostream> Platform::writeFile(const std::string&, Location) const {
+		return nullptr;
+	}
+
+	bool Platform::getFileStamp(const std::string&, Location, FileStamp&) const {
+		return false;
+	}
+
 	std::string Platform::getButtonName(const Buttons& button) {
 		if (button.back) return "ESC";
 		if (button.select) return "ENTER";
@@ -159,6 +179,8 @@ namespace SuperHaxagon {
 	}
 
 	void Platform::message(const Dbg dbg, const std::string& where, const std::string& message) const {
+		if (queueMessage(dbg, where, message)) return;
+
 		if (dbg == Dbg::INFO) {
 			std::cout << "[ndless:info] " + where + ": " + message << std::endl;
 		} else if (dbg == Dbg::WARN) {
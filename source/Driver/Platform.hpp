@@ -1,6 +1,7 @@
 #ifndef SUPER_HAXAGON_PLATFORM_HPP
 #define SUPER_HAXAGON_PLATFORM_HPP
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -38,6 +39,29 @@ namespace SuperHaxagon {
 		USER
 	};
 
+	struct FileStamp {
+		uint64_t size;
+		int64_t modified;
+	};
+
+	/**
+	 * The bytes of a whole file, read only. owner keeps them valid (a mapping
+	 * or a buffer), it's null for bytes that are always there, like compiled in.
+	 */
+	struct FileView {
+		FileView() = default;
+		FileView(const uint8_t* data, const size_t size, std::shared_ptr<const void> owner) : data(data), size(size), owner(std::move(owner)) {}
+
+		/**
+		 * Bytes that were already read into memory
+		 */
+		FileView(std::shared_ptr<const std::vector<uint8_t>> bytes) : data(bytes->data()), size(bytes->size()), owner(std::move(bytes)) {}
+
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		std::shared_ptr<const void> owner;
+	};
+
 	inline Supports operator |(Supports lhs, Supports rhs) {
 		using T = std::underlying_type_t<Supports>;
 		return static_cast<Supports>(static_cast<T>(lhs) | static_cast<T>(rhs));
@@ -63,12 +87,48 @@ namespace SuperHaxagon {
 		std::string getPath(const std::string& partial, Location location) const;
 		std::unique_ptr<std::istream> openFile(const std::string& partial, Location location) const;
 
+		/**
+		 * A whole file without a stream in the way: mapped where the platform
+		 * can, otherwise read in one go. False if there's no such file. Don't
+		 * write to a file while a view of it is around.
+		 */
+		bool mapFile(const std::string& partial, Location location, FileView& view) const;
+
+		/**
+		 * Creates (or replaces) a file, along with any missing directories.
+		 * Returns null on platforms that can't write files.
+		 */
+		std::unique_ptr<std::ostream> writeFile(const std::string& partial, Location location) const;
+
+		/**
+		 * Size and last modification time of a file (or a directory, whose
+		 * size is 0), false if there's no such file or the platform can't tell.
+		 */
+		bool getFileStamp(const std::string& partial, Location location, FileStamp& stamp) const;
+
 		std::unique_ptr<Font> loadFont(int size) const;
 		std::unique_ptr<Sound> loadSound(const std::string& base) const;
 		std::unique_ptr<Music> loadMusic(const std::string& base, Location location) const;
 
 		std::vector<std::pair<Location, std::string>> loadUserLevels();
 
+		/**
+		 * Reads or writes the raw save data that holds the score database
+		 * (EEPROM on the N64, a file in the USER location elsewhere).
+		 * Writes go to offset in the save and only touch the EEPROM blocks
+		 * they cover, unless eepfs didn't lay the EEPROM out as expected,
+		 * then the whole file is written. Returns false if the save could
+		 * not be accessed.
+		 */
+		bool readSave(uint8_t* data, size_t size) const;
+		bool writeSave(const uint8_t* data, size_t offset, size_t size) const;
+
+		/**
+		 * If writeSave really only writes the blocks it's given. False means
+		 * every write rewrites the whole save, so it's better done once.
+		 */
+		bool writesSaveBlocks() const;
+
 		static std::string getButtonName(const Buttons& button);
 		Buttons getPressed() const;
 		Point getScreenDim() const;
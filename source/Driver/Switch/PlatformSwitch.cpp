@@ -2,6 +2,7 @@
 
 #include "RenderTarget.hpp"
 #include "Core/Configuration.hpp"
+#include "Core/Parallel.hpp"
 #include "Core/Twist.hpp"
 #include "Driver/Font.hpp"
 #include "Driver/Music.hpp"
@@ -418,6 +419,8 @@ namespace SuperHaxagon {
 	}
 
 	void Platform::message(const Dbg dbg, const std::string& where, const std::string& message) const {
+		if (queueMessage(dbg, where, message)) return;
+
 		std::string format;
 		if (dbg == Dbg::INFO) {
 			format = "[switch:info] ";
@@ -1,5 +1,6 @@
 #include "Driver/Platform.hpp"
 
+#include "Core/Parallel.hpp"
 #include "Core/Twist.hpp"
 #include "Driver/Sound.hpp"
 #include "Driver/SFML/DataSFML.hpp"
@@ -28,6 +29,8 @@ namespace SuperHaxagon {
 	Platform::~Platform() = default;
 
 	void Platform::message(const Dbg dbg, const std::string& where, const std::string& message) const {
+		if (queueMessage(dbg, where, message)) return;
+
 		if (dbg == Dbg::INFO) {
 			std::cout << "[win:info] " + where + ": " + message << std::endl;
 		} else if (dbg == Dbg::WARN) {
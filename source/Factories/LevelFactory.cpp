@@ -1,77 +1,164 @@
 #include "Factories/LevelFactory.hpp"
 
 #include "Core/Game.hpp"
+#include "Core/Pack.hpp"
+#include "Core/Reader.hpp"
+#include "Core/RomPack.hpp"
 #include "Core/Twist.hpp"
 #include "Driver/Platform.hpp"
 #include "Factories/PatternFactory.hpp"
+#include "Factories/PatternLibrary.hpp"
 #include "Objects/Level.hpp"
 
 namespace SuperHaxagon {
 	const char* LevelFactory::LEVEL_HEADER = "LEV3.0";
 	const char* LevelFactory::LEVEL_FOOTER = "ENDLEV";
 
-	LevelFactory::LevelFactory(std::istream& stream, std::vector<std::shared_ptr<PatternFactory>>& shared, const Location location, Platform& platform, const size_t levelIndexOffset) {
+	LevelFactory::LevelFactory(Reader& reader, const PatternNames& names, const Location location, const size_t levelIndexOffset) {
 		_location = location;
 
-		if (!readCompare(stream, LEVEL_HEADER)) {
-			platform.message(Dbg::WARN, "level", "level header invalid!");
-			return;
-		}
+		if (!reader.compare(LEVEL_HEADER, "level header")) return;
 
-		_name = readString(stream, platform, "level name");
-		_difficulty = readString(stream, platform, _name + " level difficulty");
-		_mode = readString(stream, platform, _name + " level mode");
-		_creator = readString(stream, platform, _name + " level creator");
-		_music = "/" + readString(stream, platform, _name + " level music");
+		_name = reader.readString("level name");
+		_difficulty = reader.readString("level difficulty");
+		_mode = reader.readString("level mode");
+		_creator = reader.readString("level creator");
+		_music = "/";
+		_music += reader.readView("level music");
 
-		const auto numColorsBG1 = read32(stream, 1, 512, platform, "level background 1");
+		const auto numColorsBG1 = reader.read32(1, 512, "level background 1");
 		_colors[LocColor::BG1].reserve(numColorsBG1);
-		for (auto i = 0; i < numColorsBG1; i++) _colors[LocColor::BG1].emplace_back(readColor(stream));
+		for (auto i = 0; i < numColorsBG1; i++) _colors[LocColor::BG1].emplace_back(reader.readColor("level background 1 color"));
 
-		const auto numColorsBG2 = read32(stream, 1, 512, platform, "level background 2");
+		const auto numColorsBG2 = reader.read32(1, 512, "level background 2");
 		_colors[LocColor::BG2].reserve(numColorsBG2);
-		for (auto i = 0; i < numColorsBG2; i++) _colors[LocColor::BG2].emplace_back(readColor(stream));
+		for (auto i = 0; i < numColorsBG2; i++) _colors[LocColor::BG2].emplace_back(reader.readColor("level background 2 color"));
 
-		const auto numColorsFG = read32(stream, 1, 512, platform, "level foreground");
+		const auto numColorsFG = reader.read32(1, 512, "level foreground");
 		_colors[LocColor::FG].reserve(numColorsFG);
-		for (auto i = 0; i < numColorsFG; i++) _colors[LocColor::FG].emplace_back(readColor(stream));
+		for (auto i = 0; i < numColorsFG; i++) _colors[LocColor::FG].emplace_back(reader.readColor("level foreground color"));
 
-		_speedWall = readFloat(stream);
-		_speedRotation = readFloat(stream);
-		_speedCursor = readFloat(stream);
-		_speedPulse = read32(stream, 4, 8192, platform, "level pulse");
-		_nextIndex = read32(stream, -1, 8192, platform, "next index");
-		_nextTime = readFloat(stream);
+		_speedWall = reader.readFloat("level wall speed");
+		_speedRotation = reader.readFloat("level rotation speed");
+		_speedCursor = reader.readFloat("level cursor speed");
+		_speedPulse = reader.read32(4, 8192, "level pulse");
+		_nextIndex = reader.read32(-1, 8192, "next index");
+		_nextTime = reader.readFloat("next time");
 
 		// Negative numbers should remain invalid. -1 usually means load no other level.
 		if (_nextIndex >= 0) _nextIndex += static_cast<int>(levelIndexOffset);
 
-		const auto numPatterns = read32(stream, 1, 512, platform, "level pattern count");
+		const auto numPatterns = reader.read32(1, 512, "level pattern count");
+		_patternIndices.reserve(numPatterns);
 		for (auto i = 0; i < numPatterns; i++) {
-			auto found = false;
-			auto search = readString(stream, platform, "level pattern name match");
-			for (const auto& pattern : shared) {
-				if (pattern->getName() == search) {
-					_patterns.push_back(pattern);
-					found = true;
-					break;
-				}
-			}
-
-			if (!found) {
-				platform.message(Dbg::WARN, "level", "could not find pattern " + search + " for " + _name);
+			const auto search = reader.readView("level pattern name match");
+			const auto found = names.find(search);
+			if (found == names.end()) {
+				reader.getPlatform().message(Dbg::WARN, "level", "could not find pattern " + std::string(search) + " for " + _name);
 				return;
 			}
+
+			_patternIndices.push_back(found->second);
 		}
 
-		if (!readCompare(stream, LEVEL_FOOTER)) {
-			platform.message(Dbg::WARN, "level", "level footer invalid!");
-			return;
+		if (!reader.compare(LEVEL_FOOTER, "level footer")) return;
+
+		_loaded = reader.isOk();
+	}
+
+	LevelFactory::LevelFactory(const Pack& pack, const PackLevel& level, const std::vector<std::shared_ptr<PatternFactory>>& shared, const Location location, const size_t levelIndexOffset) {
+		_location = location;
+		_name = pack.getString(level.name);
+		_difficulty = pack.getString(level.difficulty);
+		_mode = pack.getString(level.mode);
+		_creator = pack.getString(level.creator);
+		_music = "/";
+		_music += pack.getString(level.music);
+
+		for (auto i = COLOR_LOCATION_FIRST; i != COLOR_LOCATION_LAST; i++) {
+			const auto* colors = pack.get<Color>(level.colors[i]);
+			_colors[static_cast<LocColor>(i)].assign(colors, colors + level.colorCount[i]);
 		}
 
+		_speedWall = level.speedWall;
+		_speedRotation = level.speedRotation;
+		_speedCursor = level.speedCursor;
+		_speedPulse = level.speedPulse;
+		_nextIndex = level.nextIndex;
+		_nextTime = level.nextTime;
+		if (_nextIndex >= 0) _nextIndex += static_cast<int>(levelIndexOffset);
+
+		const auto* patterns = pack.get<uint32_t>(level.patterns);
+		_patterns.reserve(level.patternCount);
+		for (uint32_t i = 0; i < level.patternCount; i++) _patterns.push_back(shared[patterns[i]]);
+
 		_loaded = true;
 	}
 
+	LevelFactory::LevelFactory(const RomLevel& level, const std::vector<std::shared_ptr<PatternFactory>>& shared, const Location location, const size_t levelIndexOffset) {
+		_location = location;
+		_name = level.name;
+		_difficulty = level.difficulty;
+		_mode = level.mode;
+		_creator = level.creator;
+		_music = "/";
+		_music += level.music;
+
+		for (auto i = COLOR_LOCATION_FIRST; i != COLOR_LOCATION_LAST; i++) {
+			_colors[static_cast<LocColor>(i)].assign(level.colors[i], level.colors[i] + level.colorCount[i]);
+		}
+
+		_speedWall = level.speedWall;
+		_speedRotation = level.speedRotation;
+		_speedCursor = level.speedCursor;
+		_speedPulse = level.speedPulse;
+		_nextIndex = level.nextIndex;
+		_nextTime = level.nextTime;
+		if (_nextIndex >= 0) _nextIndex += static_cast<int>(levelIndexOffset);
+
+		_patterns.reserve(level.patternCount);
+		for (uint32_t i = 0; i < level.patternCount; i++) _patterns.push_back(shared[level.patterns[i]]);
+
+		_loaded = true;
+	}
+
+	void LevelFactory::setPatterns(const std::vector<std::shared_ptr<PatternFactory>>& shared) {
+		_patterns.clear();
+		_patterns.reserve(_patternIndices.size());
+		for (const auto index : _patternIndices) _patterns.push_back(shared[index]);
+	}
+
+	void LevelFactory::setLibrary(std::shared_ptr<PatternLibrary> library) {
+		_library = std::move(library);
+	}
+
+	bool LevelFactory::isStreamed() const {
+		return _library && _library->isStreamed();
+	}
+
+	bool LevelFactory::loadPatterns(Platform& platform) {
+		if (hasPatterns()) return true;
+		if (!_library) return false;
+		if (!_library->isStreamed()) return _library->load(_patternIndices, platform, _patterns);
+		if (!_library->open(platform)) return false;
+
+		// Played if a pattern picked later can't be read, so there's always one
+		_firstPattern = _library->page(_patternIndices.front());
+		return _firstPattern != nullptr;
+	}
+
+	void LevelFactory::unloadPatterns() {
+		if (!_library) return;
+
+		// Patterns still used by another level (or a live one) stay in memory
+		_patterns.clear();
+		_patterns.shrink_to_fit();
+		_firstPattern = nullptr;
+
+		// A live level reopens the file if it needs another pattern
+		if (_library->isStreamed()) _library->close();
+	}
+
 	std::unique_ptr<Level> LevelFactory::instantiate(Twist& rng, float renderDistance) const {
 		return std::make_unique<Level>(*this, rng, renderDistance);
 	}
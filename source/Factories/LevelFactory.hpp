@@ -6,29 +6,93 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <map>
 
 namespace SuperHaxagon {	
 	class Game;
 	class LevelFactory;
+	class Pack;
 	class PatternFactory;
+	class PatternLibrary;
+	class Reader;
 	class Twist;
 	class Level;
+	struct PackLevel;
+	struct RomLevel;
+
+	// The pattern names of a pack and their index. If a name repeats, the first one is used.
+	using PatternNames = std::unordered_map<std::string_view, uint16_t>;
 
 	class LevelFactory {
 	public:
 		static const char* LEVEL_HEADER;
 		static const char* LEVEL_FOOTER;
 
-		LevelFactory(std::istream& stream, std::vector<std::shared_ptr<PatternFactory>>& shared, Location location, Platform& platform, size_t levelIndexOffset);
+		/**
+		 * Reads a HAX1.1 level. Patterns are matched by name against the
+		 * pack's pattern names, then supplied with setPatterns or setLibrary.
+		 */
+		LevelFactory(Reader& reader, const PatternNames& names, Location location, size_t levelIndexOffset);
+
+		/**
+		 * Creates a level from an already validated HAX2 pack
+		 */
+		LevelFactory(const Pack& pack, const PackLevel& level, const std::vector<std::shared_ptr<PatternFactory>>& shared, Location location, size_t levelIndexOffset);
+
+		/**
+		 * Creates a level from the tables compiled into the game
+		 */
+		LevelFactory(const RomLevel& level, const std::vector<std::shared_ptr<PatternFactory>>& shared, Location location, size_t levelIndexOffset);
 		LevelFactory(const LevelFactory&) = delete;
 
+		/**
+		 * Patterns must be loaded before a level is created from this
+		 */
 		std::unique_ptr<Level> instantiate(Twist& rng, float renderDistance) const;
 
+		void setPatterns(const std::vector<std::shared_ptr<PatternFactory>>& shared);
+
+		/**
+		 * Makes the patterns load on demand from an indexed pack
+		 */
+		void setLibrary(std::shared_ptr<PatternLibrary> library);
+
+		/**
+		 * Moves the link to the next level along, for packs that were read
+		 * before it was known where their levels would go
+		 */
+		void offsetNextIndex(const size_t levelIndexOffset) {
+			if (_nextIndex >= 0) _nextIndex += static_cast<int>(levelIndexOffset);
+		}
+
+		/**
+		 * Reads the patterns of an on demand level if they aren't loaded.
+		 * A streamed level only reads its first one, to be sure it can.
+		 */
+		bool loadPatterns(Platform& platform);
+
+		/**
+		 * Lets go of the patterns of an on demand level
+		 */
+		void unloadPatterns();
+
 		bool isLoaded() const {return _loaded;}
+		bool isOnDemand() const {return _library != nullptr;}
+		bool isStreamed() const;
+		bool hasPatterns() const {return !_patterns.empty() || _firstPattern;}
 
 		const std::vector<std::shared_ptr<PatternFactory>>& getPatterns() const {return _patterns;}
+
+		// For levels that page their patterns in from the library
+		const std::shared_ptr<PatternLibrary>& getLibrary() const {return _library;}
+		const std::vector<uint16_t>& getPatternIndices() const {return _patternIndices;}
+		const std::shared_ptr<PatternFactory>& getFirstPattern() const {return _firstPattern;}
+
+		// For tools that rewrite patterns
+		std::vector<std::shared_ptr<PatternFactory>>& getPatterns() {return _patterns;}
 		const std::map<LocColor, std::vector<Color>>& getColors() const {return _colors;}
 
 		const std::string& getName() const {return _name;}
@@ -56,6 +120,9 @@ namespace SuperHaxagon {
 
 	private:
 		std::vector<std::shared_ptr<PatternFactory>> _patterns;
+		std::vector<uint16_t> _patternIndices;
+		std::shared_ptr<PatternLibrary> _library;
+		std::shared_ptr<PatternFactory> _firstPattern;
 		std::map<LocColor, std::vector<Color>> _colors;
 
 		std::string _name;
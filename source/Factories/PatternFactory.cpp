@@ -1,44 +1,63 @@
 #include "Factories/PatternFactory.hpp"
 
+#include "Core/Reader.hpp"
 #include "Core/Twist.hpp"
-#include "Driver/Platform.hpp"
+
+#include <cstring>
 
 namespace SuperHaxagon {
 	const char* PatternFactory::PATTERN_HEADER = "PTN1.1";
 	const char* PatternFactory::PATTERN_FOOTER = "ENDPTN";
 
-	PatternFactory::PatternFactory(std::istream& stream, Platform& platform) {
-		_name = readString(stream, platform, "pattern name");
-
-		if (!readCompare(stream, PATTERN_HEADER)) {
-			platform.message(Dbg::WARN, "pattern", _name + " pattern header invalid!");
-			return;
-		}
+	PatternFactory::PatternFactory(Reader& reader) {
+		_name = reader.readString("pattern name");
+		if (!reader.compare(PATTERN_HEADER, "pattern header")) return;
 
 		// This might be able to be increased later
-		_sides = read32(stream, 0, 256, platform, _name + " pattern sides");
+		_sides = reader.read32(0, 256, "pattern sides");
 		if(_sides < MIN_PATTERN_SIDES) _sides = MIN_PATTERN_SIDES;
 
-		const auto numWalls = read32(stream, 1, 1000, platform, _name + " pattern walls");
-		for (auto i = 0; i < numWalls; i++) _walls.emplace_back(stream, _sides);
+		const auto numWalls = reader.read32(1, 1000, "pattern walls");
+		_storage.reserve(numWalls);
+		for (auto i = 0; i < numWalls; i++) _storage.emplace_back(reader, _sides);
+		_walls = _storage.data();
+		_wallCount = _storage.size();
 
-		if (!readCompare(stream, PATTERN_FOOTER)) {
-			platform.message(Dbg::WARN, "pattern", _name + " pattern footer invalid!");
-			return;
-		}
+		if (!reader.compare(PATTERN_FOOTER, "pattern footer")) return;
 
-		_loaded = true;
+		_loaded = reader.isOk();
 	}
 
+	PatternFactory::PatternFactory(std::string name, const int sides, const WallFactory* walls, const size_t wallCount, std::shared_ptr<const void> owner) :
+		_owner(std::move(owner)),
+		_walls(walls),
+		_wallCount(wallCount),
+		_name(std::move(name)),
+		_sides(sides),
+		_loaded(true)
+	{}
+
 	PatternFactory::~PatternFactory() = default;
 
-	Pattern PatternFactory::instantiate(Twist& rng, const float distance) const {
+	uint64_t PatternFactory::getHash() const {
+		// Walls are plain 6 byte structs, so they can be hashed as they are
+		return hashBytes(_walls, _wallCount * sizeof(WallFactory)) * 31 + static_cast<uint64_t>(_sides);
+	}
+
+	bool PatternFactory::isSameAs(const PatternFactory& other) const {
+		return _sides == other._sides &&
+			_wallCount == other._wallCount &&
+			std::memcmp(_walls, other._walls, _wallCount * sizeof(WallFactory)) == 0;
+	}
+
+	Pattern PatternFactory::instantiate(Twist& rng, const float distance, std::vector<Wall> storage) const {
 		const auto offset = rng.rand(_sides - 1);
-		std::vector<Wall> active;
-		for(const auto& wall : _walls) {
-			active.emplace_back(wall.instantiate(distance, offset, _sides));
+		storage.clear();
+		storage.reserve(_wallCount);
+		for(size_t i = 0; i < _wallCount; i++) {
+			storage.emplace_back(_walls[i].instantiate(distance, offset, _sides));
 		}
 
-		return {active, _sides};
+		return {storage, _sides};
 	}
 }
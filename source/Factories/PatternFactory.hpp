@@ -4,10 +4,12 @@
 #include "Factories/WallFactory.hpp"
 #include "Objects/Pattern.hpp"
 
+#include <memory>
 #include <vector>
 #include <string>
 
 namespace SuperHaxagon {
+	class Reader;
 	class Twist;
 	class PatternFactory {
 	public:
@@ -15,17 +17,44 @@ namespace SuperHaxagon {
 		static const char* PATTERN_FOOTER;
 		static constexpr int MIN_PATTERN_SIDES = 3;
 
-		PatternFactory(std::istream& stream, Platform& platform);
+		explicit PatternFactory(Reader& reader);
+
+		/**
+		 * A pattern whose walls live in a HAX2 pack. owner keeps them alive.
+		 */
+		PatternFactory(std::string name, int sides, const WallFactory* walls, size_t wallCount, std::shared_ptr<const void> owner);
+		PatternFactory(const PatternFactory&) = delete;
 		~PatternFactory();
 
-		Pattern instantiate(Twist& rng, float distance) const;
+		/**
+		 * Creates a live pattern. Passing the walls of a retired pattern in
+		 * as storage lets the new pattern reuse that memory instead of allocating.
+		 */
+		Pattern instantiate(Twist& rng, float distance, std::vector<Wall> storage = {}) const;
 
 		bool isLoaded() const {return _loaded;}
+		const WallFactory* getWalls() const {return _walls;}
+		size_t getWallCount() const {return _wallCount;}
 		int getSides() const {return _sides;}
-		std::string getName() const {return _name;}
+		const std::string& getName() const {return _name;}
+
+		/**
+		 * Hash of the sides and walls, the name isn't included
+		 */
+		uint64_t getHash() const;
+
+		/**
+		 * True if the other pattern plays the same, whatever it's called
+		 */
+		bool isSameAs(const PatternFactory& other) const;
 
 	private:
-		std::vector<WallFactory> _walls;
+		// Walls parsed from a HAX1.1 pack, unused when they come from a HAX2 pack
+		std::vector<WallFactory> _storage;
+		std::shared_ptr<const void> _owner;
+
+		const WallFactory* _walls = nullptr;
+		size_t _wallCount = 0;
 		std::string _name;
 		int _sides = 0;
 		bool _loaded = false;
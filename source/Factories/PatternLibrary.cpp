@@ -0,0 +1,244 @@
+#include "Factories/PatternLibrary.hpp"
+
+#include "Core/Lz.hpp"
+#include "Core/Memory.hpp"
+#include "Core/Reader.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/PatternFactory.hpp"
+
+#include <algorithm>
+
+namespace SuperHaxagon {
+	static constexpr size_t WALL_BYTES = sizeof(uint16_t) * 3;
+	static constexpr size_t COUNT_BYTES = sizeof(uint32_t);
+	static constexpr size_t TAG_BYTES = 6;
+
+	/**
+	 * What a loaded pattern is charged to MemTag::PATTERNS
+	 */
+	static size_t getPatternBytes(const size_t walls) {
+		return sizeof(PatternFactory) + walls * sizeof(WallFactory);
+	}
+
+	/**
+	 * A count in a HAX1.1 pack, clamped the way Reader::read32 does but
+	 * without reporting it. The Reader going over the bytes after reports it.
+	 */
+	static size_t peekCount(const uint8_t* data, const int32_t min, const int32_t max) {
+		const auto num = static_cast<int32_t>(data[0] | data[1] << 8 | data[2] << 16 | static_cast<uint32_t>(data[3]) << 24);
+		return static_cast<size_t>(std::clamp(num, min, max));
+	}
+
+	/**
+	 * Appends size bytes from the stream to buffer
+	 */
+	static bool append(std::istream& stream, std::vector<uint8_t>& buffer, const size_t size) {
+		const auto at = buffer.size();
+		buffer.resize(at + size);
+		stream.read(reinterpret_cast<char*>(buffer.data() + at), static_cast<std::streamsize>(size));
+		return static_cast<size_t>(stream.gcount()) == size;
+	}
+
+	std::shared_ptr<PatternFactory> PatternPool::share(const std::shared_ptr<PatternFactory>& pattern) {
+		const auto hash = pattern->getHash();
+#ifdef HAXAGON_THREADS
+		std::lock_guard<std::mutex> lock(_mutex);
+#endif
+
+		// Two different patterns can have the same hash. The one in the pool keeps
+		// its place then, and the other is kept to its own pack.
+		auto& slot = _patterns[hash];
+		const auto pooled = slot.lock();
+		if (pooled && pooled->isSameAs(*pattern)) return pooled;
+		if (!pooled) slot = pattern;
+		return pattern;
+	}
+
+	void PatternPool::keep(const std::shared_ptr<PatternFactory>& pattern, const size_t bytes) {
+		const auto found = std::find_if(_recent.begin(), _recent.end(), [&](const auto& recent) {return recent.first == pattern;});
+		if (found != _recent.end()) {
+			std::rotate(found, found + 1, _recent.end());
+			return;
+		}
+
+		_recent.emplace_back(pattern, bytes);
+		_recentBytes += bytes;
+		while (_recent.size() > 1 && _recentBytes > RECENT_BUDGET) {
+			_recentBytes -= _recent.front().second;
+			_recent.erase(_recent.begin());
+		}
+	}
+
+	PatternLibrary::PatternLibrary(std::string path, const Location location, std::shared_ptr<PatternPool> pool) :
+		_pool(pool ? std::move(pool) : std::make_shared<PatternPool>()),
+		_path(std::move(path)),
+		_location(location)
+	{}
+
+	std::string_view PatternLibrary::index(Reader& reader, const size_t base) {
+		const auto start = reader.getOffset();
+
+		// Same layout PatternFactory reads, but the walls are only stepped over
+		const auto name = reader.readView("pattern name");
+		if (!reader.compare(PatternFactory::PATTERN_HEADER, "pattern header")) return {};
+		const auto sides = std::max(reader.read32(0, 256, "pattern sides"), PatternFactory::MIN_PATTERN_SIDES);
+		const auto numWalls = reader.read32(1, 1000, "pattern walls");
+		if (!reader.skip(numWalls * WALL_BYTES, "pattern walls")) return {};
+		if (!reader.compare(PatternFactory::PATTERN_FOOTER, "pattern footer")) return {};
+
+		_entries.push_back({
+			static_cast<uint32_t>(base + start),
+			static_cast<uint32_t>(reader.getOffset() - start),
+			static_cast<uint16_t>(numWalls),
+			static_cast<uint16_t>(sides),
+			{}
+		});
+
+		return name;
+	}
+
+	bool PatternLibrary::index(std::istream& stream, size_t& offset, Platform& platform, const char* file, std::string& name) {
+		// The name's length says where the wall count is, and that says how much is left
+		_buffer.clear();
+		if (!append(stream, _buffer, COUNT_BYTES)) return false;
+		const auto nameLength = peekCount(_buffer.data(), 1, 300);
+		if (!append(stream, _buffer, nameLength + TAG_BYTES + COUNT_BYTES * 2)) return false;
+		const auto numWalls = peekCount(_buffer.data() + _buffer.size() - COUNT_BYTES, 1, 1000);
+		if (!append(stream, _buffer, numWalls * WALL_BYTES + TAG_BYTES)) return false;
+
+		Reader reader(_buffer.data(), _buffer.size(), platform, file);
+		name = index(reader, offset);
+		offset += _buffer.size();
+		return reader.isOk() && reader.getOffset() == _buffer.size();
+	}
+
+	bool PatternLibrary::load(const std::vector<uint16_t>& indices, Platform& platform, std::vector<std::shared_ptr<PatternFactory>>& patterns) {
+		patterns.clear();
+		patterns.resize(indices.size());
+
+		// A file stored as it is is mapped and patterns are read where they lie. A compressed
+		// one is decompressed up to each pattern instead, in file order so it's never restarted.
+		std::vector<size_t> order(indices.size());
+		for (size_t i = 0; i < order.size(); i++) order[i] = i;
+		std::sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {return _entries[indices[a]].offset < _entries[indices[b]].offset;});
+
+		std::unique_ptr<std::istream> stream;
+		std::vector<uint8_t> buffer;
+		FileView file;
+		for (const auto i : order) {
+			const auto index = indices[i];
+			auto& entry = _entries[index];
+			auto pattern = entry.loaded.lock();
+			if (!pattern) {
+				if (!stream && !file.data) {
+					stream = Lz::open(platform.openFile(_path, _location));
+					if (stream && *stream && !Lz::isCompressed(*stream)) {
+						stream = nullptr;
+						platform.mapFile(_path, _location, file);
+					}
+
+					if ((!stream || !*stream) && !file.data) {
+						platform.message(Dbg::WARN, "library", _path + ": could not be reopened");
+						patterns.clear();
+						return false;
+					}
+				}
+
+				const uint8_t* data = nullptr;
+				if (file.data) {
+					if (entry.offset <= file.size && entry.size <= file.size - entry.offset) data = file.data + entry.offset;
+				} else {
+					stream->clear();
+					stream->seekg(entry.offset);
+					buffer.clear();
+					if (append(*stream, buffer, entry.size)) data = buffer.data();
+				}
+
+				if (!data) {
+					platform.message(Dbg::WARN, "library", _path + ": pattern " + std::to_string(index) + " could not be read");
+					patterns.clear();
+					return false;
+				}
+
+				pattern = read(entry, data, platform);
+				if (!pattern) {
+					patterns.clear();
+					return false;
+				}
+			}
+
+			patterns[i] = std::move(pattern);
+		}
+
+		return true;
+	}
+
+	bool PatternLibrary::open(Platform& platform) {
+		_platform = &platform;
+		if (_stream) return true;
+
+		_stream = Lz::open(platform.openFile(_path, _location));
+		if (!*_stream) {
+			platform.message(Dbg::WARN, "library", _path + ": could not be reopened");
+			_stream = nullptr;
+			return false;
+		}
+
+		// Only streamed if it wasn't compressed at boot. A seek back would decompress it from the start, mid level.
+		if (Lz::isCompressed(*_stream)) {
+			platform.message(Dbg::WARN, "library", _path + ": is compressed now, it can't be streamed");
+			_stream = nullptr;
+			return false;
+		}
+
+		return true;
+	}
+
+	void PatternLibrary::close() {
+		_stream = nullptr;
+		_buffer.clear();
+		_buffer.shrink_to_fit();
+	}
+
+	std::shared_ptr<PatternFactory> PatternLibrary::page(const uint16_t index) {
+		auto& entry = _entries[index];
+		auto pattern = entry.loaded.lock();
+		if (!pattern) {
+			if (!_platform || !open(*_platform)) return nullptr;
+
+			_stream->clear();
+			_stream->seekg(entry.offset);
+			_buffer.clear();
+			if (!append(*_stream, _buffer, entry.size)) {
+				_platform->message(Dbg::WARN, "library", _path + ": pattern " + std::to_string(index) + " could not be read");
+				close();
+				return nullptr;
+			}
+
+			pattern = read(entry, _buffer.data(), *_platform);
+			if (!pattern) return nullptr;
+		}
+
+		_pool->keep(pattern, getPatternBytes(entry.walls));
+		return pattern;
+	}
+
+	std::shared_ptr<PatternFactory> PatternLibrary::read(Entry& entry, const uint8_t* data, Platform& platform) const {
+		Reader reader(data, entry.size, platform, _path.c_str());
+		auto factory = std::make_unique<PatternFactory>(reader);
+		if (!factory->isLoaded()) return nullptr;
+
+		// Charged while anything holds the pattern, released with the last one. If the
+		// pool already has it, this copy goes away again right here.
+		const auto bytes = getPatternBytes(factory->getWallCount());
+		Memory::charge(MemTag::PATTERNS, bytes);
+		std::shared_ptr<PatternFactory> parsed(factory.release(), [bytes](const PatternFactory* loaded) {
+			Memory::release(MemTag::PATTERNS, bytes);
+			delete loaded;
+		});
+
+		auto pattern = _pool->share(parsed);
+		entry.loaded = pattern;
+		return pattern;
+	}
+}
@@ -0,0 +1,143 @@
+#ifndef SUPER_HAXAGON_PATTERN_LIBRARY_HPP
+#define SUPER_HAXAGON_PATTERN_LIBRARY_HPP
+
+#include "Core/Parallel.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef HAXAGON_THREADS
+#include <mutex>
+#endif
+
+namespace SuperHaxagon {
+	enum class Location;
+	class PatternFactory;
+	class Platform;
+	class Reader;
+
+	/**
+	 * Patterns in memory by the hash of their walls, so a pattern that is in
+	 * several packs (or twice in one) is only loaded once, whichever kind of
+	 * pack it came from. A hash is only where to look, a pattern is shared
+	 * once its walls are compared too.
+	 */
+	class PatternPool {
+	public:
+		// Bytes of streamed patterns kept after they're played, in case they're picked again
+		static constexpr size_t RECENT_BUDGET = 64 * 1024;
+
+		/**
+		 * The pattern in the pool with the same walls, or pattern itself, which
+		 * is added unless a different one has its hash. Packs are read on
+		 * several threads at boot, so this can be called from any of them.
+		 */
+		std::shared_ptr<PatternFactory> share(const std::shared_ptr<PatternFactory>& pattern);
+
+		/**
+		 * Holds on to a pattern that was just used, letting go of the ones
+		 * used longest ago once they add up to more than RECENT_BUDGET.
+		 * Only while playing, from the main thread.
+		 */
+		void keep(const std::shared_ptr<PatternFactory>& pattern, size_t bytes);
+
+	private:
+#ifdef HAXAGON_THREADS
+		std::mutex _mutex;
+#endif
+		std::unordered_map<uint64_t, std::weak_ptr<PatternFactory>> _patterns;
+		std::vector<std::pair<std::shared_ptr<PatternFactory>, size_t>> _recent;
+		size_t _recentBytes = 0;
+	};
+
+	/**
+	 * The patterns of a HAX1.1 pack that were only indexed at boot. Each entry
+	 * remembers where its pattern is in the file, and the pattern is read from
+	 * there when a level needs it. Loaded patterns are shared between the levels
+	 * using them and freed once none of them do.
+	 *
+	 * Packs too large to have whole levels in memory are streamed: a level only
+	 * holds its first pattern, the others are read one at a time as they're
+	 * picked and kept in the pool's recent patterns while there's room.
+	 */
+	class PatternLibrary {
+	public:
+		/**
+		 * Libraries given the same pool share identical patterns. Without one
+		 * they're only shared within this pack.
+		 */
+		PatternLibrary(std::string path, Location location, std::shared_ptr<PatternPool> pool = nullptr);
+		PatternLibrary(const PatternLibrary&) = delete;
+
+		/**
+		 * Records the pattern at the reader's offset and steps over its walls.
+		 * Returns the pattern's name, which points into the reader's data.
+		 */
+		std::string_view index(Reader& reader, size_t base = 0);
+
+		/**
+		 * The same, for a pack read through a stream, offset being where in the
+		 * file it is and moved past the pattern. Only one pattern is in memory
+		 * at a time, name is given a copy of its name.
+		 */
+		bool index(std::istream& stream, size_t& offset, Platform& platform, const char* file, std::string& name);
+
+		size_t size() const {return _entries.size();}
+		int getSides(const uint16_t index) const {return _entries[index].sides;}
+		size_t getWallCount(const uint16_t index) const {return _entries[index].walls;}
+
+		void setStreamed(const bool streamed) {_streamed = streamed;}
+		bool isStreamed() const {return _streamed;}
+
+		/**
+		 * Fills patterns with the given entries, reading the ones that aren't
+		 * in memory from the file. patterns is left empty if any fail.
+		 */
+		bool load(const std::vector<uint16_t>& indices, Platform& platform, std::vector<std::shared_ptr<PatternFactory>>& patterns);
+
+		/**
+		 * Opens the file so patterns can be paged in. The platform is kept
+		 * for reopening it if it was closed in between. Compressed files
+		 * aren't paged from, seeking back in one would decompress it again.
+		 */
+		bool open(Platform& platform);
+		void close();
+
+		/**
+		 * Reads one pattern from the open file, unless it's in the pool.
+		 * Null if it could not be read.
+		 */
+		std::shared_ptr<PatternFactory> page(uint16_t index);
+
+	private:
+		struct Entry {
+			uint32_t offset;
+			uint32_t size;
+			uint16_t walls;
+			uint16_t sides; // Raised to the minimum like PatternFactory does
+
+			// What it was last read as, possibly shared. Already compared, so it's used without reading again.
+			std::weak_ptr<PatternFactory> loaded;
+		};
+
+		std::shared_ptr<PatternFactory> read(Entry& entry, const uint8_t* data, Platform& platform) const;
+
+		std::vector<Entry> _entries;
+		std::shared_ptr<PatternPool> _pool;
+		std::string _path;
+		Location _location;
+		bool _streamed = false;
+
+		// Only used while streaming, the buffer holds one pattern at a time
+		std::unique_ptr<std::istream> _stream;
+		std::vector<uint8_t> _buffer;
+		Platform* _platform = nullptr;
+	};
+}
+
+#endif //SUPER_HAXAGON_PATTERN_LIBRARY_HPP
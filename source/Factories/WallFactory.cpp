@@ -1,10 +1,12 @@
 #include "Factories/WallFactory.hpp"
 
+#include "Core/Reader.hpp"
+
 namespace SuperHaxagon {
-	WallFactory::WallFactory(std::istream& stream, const int maxSides) {
-		_distance = read16(stream);
-		_height = read16(stream);
-		_side = read16(stream);
+	WallFactory::WallFactory(Reader& reader, const int maxSides) {
+		_distance = reader.read16("wall distance");
+		_height = reader.read16("wall height");
+		_side = reader.read16("wall side");
 
 		if(_height < MIN_WALL_HEIGHT) _height = MIN_WALL_HEIGHT;
 		if(_side >= maxSides) _side = static_cast<uint16_t>(maxSides) - 1;
@@ -4,22 +4,34 @@
 #include "Core/Structs.hpp"
 #include "Objects/Wall.hpp"
 
+#include <type_traits>
 #include <vector>
 
 namespace SuperHaxagon {
+	class Reader;
+
 	class WallFactory {
 	public:
 		static constexpr int MIN_WALL_HEIGHT = 4;
 
-		WallFactory(std::istream& stream, int maxSides);
+		WallFactory(Reader& reader, int maxSides);
+		constexpr WallFactory(uint16_t distance, uint16_t height, uint16_t side) : _distance(distance), _height(height), _side(side) {}
 
 		Wall instantiate(float offsetDistance, int offsetSide, int sides) const;
 
+		constexpr uint16_t getDistance() const {return _distance;}
+		constexpr uint16_t getHeight() const {return _height;}
+		constexpr uint16_t getSide() const {return _side;}
+
 	private:
 		uint16_t _distance = 0;
 		uint16_t _height = 0;
 		uint16_t _side = 0;
 	};
+
+	// HAX2 packs store walls exactly like this, so they can be used in place
+	static_assert(sizeof(WallFactory) == sizeof(uint16_t) * 3, "WallFactory must match the HAX2 wall layout");
+	static_assert(std::is_standard_layout<WallFactory>::value, "WallFactory must match the HAX2 wall layout");
 }
 
 #endif //SUPER_HAXAGON_WALL_FACTORY_HPP
@@ -1,13 +1,25 @@
 #include "Objects/Level.hpp"
 
 #include "Core/Game.hpp"
+#include "Core/Memory.hpp"
 #include "Core/Twist.hpp"
 #include "Driver/Platform.hpp"
 #include "Factories/LevelFactory.hpp"
 #include "Factories/PatternFactory.hpp"
+#include "Factories/PatternLibrary.hpp"
+
+#include <algorithm>
 
 namespace SuperHaxagon {
 	Level::Level(const LevelFactory& factory, Twist& rng, const float patternDistCreate) : _factory(&factory) {
+		_patterns.reserve(RESERVE_PATTERNS);
+		_spareWalls.reserve(RESERVE_PATTERNS);
+		setWinFactory(&factory);
+
+		// Storage for as many patterns as are usually live, so the first ones made while playing don't allocate
+		_spareWalls.resize(RESERVE_PATTERNS);
+		for (auto& walls : _spareWalls) walls.reserve(_maxWalls);
+
 		for (auto i = COLOR_LOCATION_FIRST; i != COLOR_LOCATION_LAST; i++) {
 			const auto location = static_cast<LocColor>(i);
 			const auto& colors = factory.getColors().at(location);
@@ -17,15 +29,18 @@ namespace SuperHaxagon {
 		}
 
 		//fetch a starting pattern
-		_patterns.emplace_back(getRandomPattern(rng).instantiate(rng, patternDistCreate));
+		_patterns.emplace_back(createPattern(rng, patternDistCreate));
 
 		//set up the amount of sides the level should have.
 		_sidesLast = _patterns.front().getSides();
 		_sidesCurrent = _patterns.front().getSides();
 		_cursorPos = TAU/4.0f + (factory.getSpeedCursor() / 2.0f);
+		updateMemory();
 	}
 
-	Level::~Level() = default;
+	Level::~Level() {
+		Memory::release(MemTag::LEVEL, _memoryCharged);
+	}
 
 	void Level::update(Twist& rng, const float patternDistDelete, const float patternDistCreate, const float dilation) {
 		// Update frame
@@ -96,6 +111,8 @@ namespace SuperHaxagon {
 			_multiplierRot *= -1.0f;
 			_flipFrame = rng.rand(FLIP_FRAMES_MIN, FLIP_FRAMES_MAX);
 		}
+
+		updateMemory();
 	}
 
 	void Level::draw(Game& game, const float scale, const float offsetWall) const {
@@ -152,6 +169,26 @@ namespace SuperHaxagon {
 		return collision;
 	}
 
+	size_t Level::getMemoryUsage() const {
+		auto bytes = sizeof(Level) + _patterns.size() * sizeof(Pattern);
+		for (const auto& pattern : _patterns) {
+			bytes += pattern.getWalls().capacity() * sizeof(Wall);
+		}
+
+		for (const auto& walls : _spareWalls) {
+			bytes += walls.capacity() * sizeof(Wall);
+		}
+
+		return bytes;
+	}
+
+	void Level::updateMemory() {
+		const auto usage = getMemoryUsage();
+		if (usage > _memoryCharged) Memory::charge(MemTag::LEVEL, usage - _memoryCharged);
+		if (usage < _memoryCharged) Memory::release(MemTag::LEVEL, _memoryCharged - usage);
+		_memoryCharged = usage;
+	}
+
 	void Level::increaseMultiplier() {
 		const auto dir = (_multiplierRot > 0 ? 1 : -1);
 		_multiplierRot += static_cast<float>(dir) * DIFFICULTY_SCALAR_ROT;
@@ -159,6 +196,7 @@ namespace SuperHaxagon {
 	}
 
 	void Level::clearPatterns() {
+		for (auto& pattern : _patterns) recycle(pattern);
 		_patterns.clear();
 	}
 
@@ -195,6 +233,33 @@ namespace SuperHaxagon {
 
 	void Level::setWinFactory(const LevelFactory* factory) {
 		_factory = factory;
+
+		// The level keeps its own references to the patterns it picks from, so
+		// they outlive the factory's if those are evicted while this is live.
+		// A factory without patterns loaded keeps using the previous ones.
+		if (!_factory->hasPatterns()) return;
+
+		// Spare storage is reserved for the largest pattern so it never has to grow
+		_maxWalls = 0;
+		if (_factory->isStreamed()) {
+			_sources.clear();
+			_library = _factory->getLibrary();
+			_indices = _factory->getPatternIndices();
+			_paged = _factory->getFirstPattern();
+			for (const auto index : _indices) {
+				_maxWalls = std::max(_maxWalls, _library->getWallCount(index));
+			}
+
+			return;
+		}
+
+		_library = nullptr;
+		_indices.clear();
+		_paged = nullptr;
+		_sources = _factory->getPatterns();
+		for (const auto& pattern : _sources) {
+			_maxWalls = std::max(_maxWalls, pattern->getWallCount());
+		}
 	}
 
 	void Level::setWinSides(const int sides) {
@@ -217,7 +282,8 @@ namespace SuperHaxagon {
 		// Shift patterns forward
 		if (_patterns.front().getFurthestWallDistance() < patternDistDelete) {
 			_sidesLast = _patterns.front().getSides();
-			_patterns.pop_front();
+			recycle(_patterns.front());
+			_patterns.erase(_patterns.begin());
 			_sidesCurrent = _patterns.front().getSides();
 
 			// Delay the level if the shifted pattern does  not have the same sides as the last.
@@ -229,30 +295,32 @@ namespace SuperHaxagon {
 
 		// Create new pattern if needed
 		if (_patterns.size() < 2 || _patterns.back().getFurthestWallDistance() < patternDistCreate) {
-			_patterns.emplace_back(getRandomPattern(rng).instantiate(rng, _patterns.back().getFurthestWallDistance()));
+			_patterns.emplace_back(createPattern(rng, _patterns.back().getFurthestWallDistance()));
 		}
 	}
 
 	auto Level::reverseWalls(Twist& rng, const float patternDistDelete, const float patternDistCreate) -> void {
 		if (_patterns.back().getClosestWallDistance() > patternDistDelete && _patterns.size() > 1) {
+			recycle(_patterns.back());
 			_patterns.pop_back();
 		}
 
 		// Create a new pattern at the front.
 		// We need to advance it so the last wall is where we create the patterns
 		if (_patterns.front().getClosestWallDistance() > patternDistCreate + _frontGap && _autoPatternCreate) {
-			auto pattern = getRandomPattern(rng).instantiate(rng, patternDistCreate);
+			auto pattern = createPattern(rng, patternDistCreate);
 			_frontGap = pattern.getClosestWallDistance() * 1.5f; // Too small of a gap otherwise
 			pattern.advance(pattern.getFurthestWallDistance());
-			_patterns.emplace_front(pattern);
-			if (pattern.getSides() != _sidesCurrent) setWinSides(pattern.getSides());
+			const auto sides = pattern.getSides();
+			_patterns.insert(_patterns.begin(), std::move(pattern));
+			if (sides != _sidesCurrent) setWinSides(sides);
 		}
 	}
 
 	const PatternFactory& Level::getRandomPattern(Twist& rng) {
-		const auto& patterns = _factory->getPatterns();
+		const auto count = static_cast<int>(getSourceCount());
 		if (_sameCount <= 0) {
-			const auto& pattern = *patterns[rng.rand(static_cast<int>(patterns.size()) - 1)];
+			const auto& pattern = getSource(rng.rand(count - 1));
 			if (pattern.getSides() != _sameSides) {
 				_sameSides = pattern.getSides();
 				_sameCount = rng.rand(MIN_SAME_SIDES, MAX_SAME_SIDES);
@@ -262,22 +330,58 @@ namespace SuperHaxagon {
 		}
 
 		_sameCount--;
-		std::vector<std::shared_ptr<PatternFactory>> selectable;
-		for (const auto& pattern : patterns) {
-			if (pattern->getSides() == _sameSides) {
-				selectable.push_back(pattern);
-			}
+		auto selectable = 0;
+		for (auto i = 0; i < count; i++) {
+			if (getSourceSides(i) == _sameSides) selectable++;
 		}
 
 		// While this never should be hit, it's possible to change the factory
 		// during runtime so a new factory might not have levels with the same
 		// amount of sides as the last one
-		if (selectable.empty()) {
+		if (selectable == 0) {
 			_sameCount = 0;
 			_sameSides = 0;
-			return *patterns[rng.rand(static_cast<int>(patterns.size()) - 1)];
+			return getSource(rng.rand(count - 1));
 		} 
 
-		return *selectable[rng.rand(static_cast<int>(selectable.size()) - 1)];
+		// Pick the nth pattern with matching sides, without building a list of them
+		auto pick = rng.rand(selectable - 1);
+		for (auto i = 0; i < count; i++) {
+			if (getSourceSides(i) == _sameSides && pick-- == 0) return getSource(i);
+		}
+
+		return getSource(0);
+	}
+
+	size_t Level::getSourceCount() const {
+		return _library ? _indices.size() : _sources.size();
+	}
+
+	int Level::getSourceSides(const size_t source) const {
+		return _library ? _library->getSides(_indices[source]) : _sources[source]->getSides();
+	}
+
+	const PatternFactory& Level::getSource(const size_t source) {
+		if (!_library) return *_sources[source];
+
+		// Streamed patterns are read as they're picked. If one can't be, the last one is played again.
+		if (auto pattern = _library->page(_indices[source])) _paged = std::move(pattern);
+		return *_paged;
+	}
+
+	Pattern Level::createPattern(Twist& rng, const float distance) {
+		std::vector<Wall> storage;
+		if (_spareWalls.empty()) {
+			storage.reserve(_maxWalls);
+		} else {
+			storage = std::move(_spareWalls.back());
+			_spareWalls.pop_back();
+		}
+
+		return getRandomPattern(rng).instantiate(rng, distance, std::move(storage));
+	}
+
+	void Level::recycle(Pattern& pattern) {
+		_spareWalls.emplace_back(pattern.takeWalls());
 	}
 }
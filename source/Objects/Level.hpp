@@ -4,13 +4,15 @@
 #include "Core/Structs.hpp"
 #include "Objects/Pattern.hpp"
 
-#include <deque>
 #include <map>
+#include <memory>
+#include <vector>
 
 namespace SuperHaxagon {	
 	class Game;
 	class LevelFactory;
 	class PatternFactory;
+	class PatternLibrary;
 	class Twist;
 
 	class Level {
@@ -27,6 +29,7 @@ namespace SuperHaxagon {
 		static constexpr float PULSE_DISTANCE = 5.0f;
 		static constexpr int MIN_SAME_SIDES = 3;
 		static constexpr int MAX_SAME_SIDES = 5;
+		static constexpr size_t RESERVE_PATTERNS = 8;
 
 		Level(const LevelFactory& factory, Twist& rng, float patternDistCreate);
 		Level(Level&) = delete;
@@ -51,10 +54,17 @@ namespace SuperHaxagon {
 		// Time
 		float getFrame() const {return _frame;}
 
+		/**
+		 * Estimates the bytes held by the level's live patterns and walls
+		 */
+		size_t getMemoryUsage() const;
+
 		const LevelFactory& getLevelFactory() const {return *_factory;}
 
+		const std::vector<Pattern>& getPatterns() const {return _patterns;}
+
 		// Stuff for Win control
-		std::deque<Pattern>& getPatterns() {return _patterns;}
+		std::vector<Pattern>& getPatterns() {return _patterns;}
 		void setWinMultiplierRot(const float multiplier) {_multiplierRot = multiplier;}
 		void setWinMultiplierWalls(const float multiplier) {_multiplierWalls = multiplier;}
 		void setWinAutoPatternCreate(const bool autoPatternCreate) {_autoPatternCreate = autoPatternCreate;}
@@ -69,10 +79,28 @@ namespace SuperHaxagon {
 		void advanceWalls(Twist& rng, float patternDistDelete, float patternDistCreate);
 		void reverseWalls(Twist& rng, float patternDistDelete, float patternDistCreate);
 		const PatternFactory& getRandomPattern(Twist& rng);
+		size_t getSourceCount() const;
+		int getSourceSides(size_t source) const;
+		const PatternFactory& getSource(size_t source);
+		Pattern createPattern(Twist& rng, float distance);
+		void recycle(Pattern& pattern);
+		void updateMemory();
 		
 		const LevelFactory* _factory;
+		std::vector<std::shared_ptr<PatternFactory>> _sources;
+
+		// Where a streamed level reads the patterns it picks, and the last one it read
+		std::shared_ptr<PatternLibrary> _library;
+		std::vector<uint16_t> _indices;
+		std::shared_ptr<PatternFactory> _paged;
 
-		std::deque<Pattern> _patterns;
+		// Patterns are only ever a handful long, so a vector is cheaper than a
+		// deque and, unlike a deque, never allocates once it has grown.
+		std::vector<Pattern> _patterns;
+
+		// Wall storage of retired patterns, reused by new ones
+		std::vector<std::vector<Wall>> _spareWalls;
+		size_t _maxWalls = 0;
 
 		bool _autoPatternCreate = false;
 		bool _showCursor = true;
@@ -105,6 +133,8 @@ namespace SuperHaxagon {
 		float _pulse = 0.0;
 		float _spin = 0.0;
 		float _frontGap = 0.0;
+
+		size_t _memoryCharged = 0;
 	};
 }
 
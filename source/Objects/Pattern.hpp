@@ -14,6 +14,11 @@ namespace SuperHaxagon {
 		const std::vector<Wall>& getWalls() const {return _walls;}
 		int getSides() const {return _sides;}
 
+		/**
+		 * Moves the walls out so their storage can be reused by the next pattern
+		 */
+		std::vector<Wall> takeWalls() {return std::move(_walls);}
+
 		float getFurthestWallDistance() const;
 		float getClosestWallDistance() const;
 		void advance(float speed);
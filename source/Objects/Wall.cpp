@@ -53,7 +53,7 @@ namespace SuperHaxagon {
 		return Movement::CAN_MOVE;
 	}
 
-	std::vector<Point> Wall::calcPoints(const Point& focus, const float rotation, const float sides, const float offset, const float scale) const {
+	std::array<Point, 4> Wall::calcPoints(const Point& focus, const float rotation, const float sides, const float offset, const float scale) const {
 		
 		auto tHeight = _height;
 		auto tDistance = _distance + offset;
@@ -64,14 +64,12 @@ namespace SuperHaxagon {
 
 		tDistance *= scale;
 		tHeight *= scale;
-		std::vector<Point> quad{
+		return {
 			calcPoint(focus, rotation, -WALL_OVERFLOW, tDistance, sides, _side),
 			calcPoint(focus, rotation, -WALL_OVERFLOW, tDistance + tHeight, sides, _side),
 			calcPoint(focus, rotation, WALL_OVERFLOW, tDistance + tHeight, sides, _side + 1),
 			calcPoint(focus, rotation, WALL_OVERFLOW, tDistance, sides, _side + 1)
 		};
-
-		return quad;
 	}
 
 	Point Wall::calcPoint(const Point& focus, const float rotation, const float overflow, const float distance, const float sides, const int side) {
@@ -3,7 +3,7 @@
 
 #include "Core/Structs.hpp"
 
-#include <vector>
+#include <array>
 
 namespace SuperHaxagon {
 	class Wall {
@@ -17,7 +17,7 @@ namespace SuperHaxagon {
 
 		void advance(float speed);
 		Movement collision(float cursorHeight, float cursorPos, float cursorStep, int sides) const;
-		std::vector<Point> calcPoints(const Point& focus, float rotation, float sides, float offset, float scale) const;
+		std::array<Point, 4> calcPoints(const Point& focus, float rotation, float sides, float offset, float scale) const;
 		static Point calcPoint(const Point& focus, float rotation, float overflow, float distance, float sides, int side);
 
 		float getDistance() const {return _distance;}
@@ -1,188 +1,369 @@
 #include "States/Load.hpp"
 
+#include "Core/FlightRecorder.hpp"
 #include "Core/Game.hpp"
+#include "Core/LevelCache.hpp"
+#include "Core/Log.hpp"
+#include "Core/Lz.hpp"
+#include "Core/Memory.hpp"
+#include "Core/Parallel.hpp"
+#include "Core/Pack.hpp"
+#include "Core/Reader.hpp"
+#include "Core/RomPack.hpp"
+#include "Core/ScoreDb.hpp"
 #include "Driver/Platform.hpp"
 #include "Factories/LevelFactory.hpp"
 #include "Factories/PatternFactory.hpp"
+#include "Factories/PatternLibrary.hpp"
 #include "States/Menu.hpp"
 #include "States/Quit.hpp"
 
+#include <algorithm>
 #include <memory>
-#include <fstream>
-#include <climits>
-
-#include <libdragon.h>
-
-class membuf : public std::basic_streambuf<char> {
-	public:
-	  membuf(const uint8_t *p, size_t l) {
-		setg((char*)p, (char*)p, (char*)p + l);
-	  }
-	};
-
-	class memstream : public std::istream {
-		public:
-		  memstream(const uint8_t *p, size_t l) :
-			std::istream(&_buffer),
-			_buffer(p, l) {
-			rdbuf(&_buffer);
-		  }
-		
-		private:
-		  membuf _buffer;
-		};
-
-
-		uint8_t* readdata(uint8_t* ptr, uint8_t* dst, int size){
-			int i = 0;
-			for(; i < size; i++){
-				dst[i] = ptr[i];
-			}
-			return ptr + i;
-		}
-		
-		uint8_t* readdatastring(uint8_t* ptr, std::string& str) {
-			int32_t len;
-			ptr = readdata(ptr, (uint8_t*)reinterpret_cast<char*>(&len), sizeof(len));
-			debugf("len %li\n", len);
-			str = std::string(len, '\0');
-			ptr = readdata(ptr, (uint8_t*)str.c_str(), len);
-			return ptr;
-		}
+#include <unordered_map>
+#include <cstring>
 
 namespace SuperHaxagon {
 	const char* Load::PROJECT_HEADER = "HAX1.1";
 	const char* Load::PROJECT_FOOTER = "ENDHAX";
-	const char* Load::SCORE_HEADER = "SCDB1.0";
-	const char* Load::SCORE_FOOTER = "ENDSCDB";
+
+	static const Color BACKGROUND = {0x20, 0x20, 0x20, 0xFF};
 
 	Load::Load(Game& game) : _game(game), _platform(game.getPlatform()) {}
 	Load::~Load() = default;
 
-	bool Load::loadLevels(std::istream& stream, Location location) const {
-		std::vector<std::shared_ptr<PatternFactory>> patterns;
+	bool Load::loadLevels(std::istream& stream, const Location location, const std::string& name) const {
+		// One bulk read, then the whole pack is used straight from memory
+		std::vector<std::unique_ptr<LevelFactory>> levels;
+		const auto loaded = readPack(std::make_shared<const std::vector<uint8_t>>(readAll(stream)), location, name, levels);
+		addLevels(levels);
+		return loaded;
+	}
+
+	bool Load::loadLevels(const LevelCache& cache, const std::string& path, const Location location, std::vector<std::unique_ptr<LevelFactory>>& levels) const {
+		// Big HAX1.1 packs aren't compiled into the cache either, that would have every wall in memory.
+		// The size is the stream's own, platforms without file stamps (rom:/ on the N64) stream them too.
+		if (const auto stream = Lz::open(_platform.openFile(path, location)); stream && *stream) {
+			char header[6]{};
+			stream->read(header, sizeof(header));
+			const auto size = stream->seekg(0, std::ios::end) ? static_cast<uint64_t>(stream->tellg()) : 0;
+			if (std::memcmp(header, PROJECT_HEADER, sizeof(header)) == 0 && size > STREAM_SIZE) {
+				// Paging seeks back and forth, and every seek back in a compressed file decodes it from the start again
+				if (Lz::isCompressed(*stream)) {
+					log<Dbg::INFO>(_platform, "file", [&] {return path + " is compressed, so it is read whole instead of streamed";});
+				} else if (stream->seekg(0)) {
+					return streamLevels(*stream, std::make_shared<PatternLibrary>(path, location, _game.getPatternPool()), _platform, path, location, 0, levels);
+				}
+			}
+		}
+
+		if (const auto cached = cache.find(path, location); cached.data) {
+			if (readPack(cached, location, path, levels)) return true;
+			log<Dbg::INFO>(_platform, "cache", [&] {return "cached " + path + " did not load, compiling it again";});
+		}
 
-		// Used to make sure that external levels link correctly.
+		// Mapped and used where it lies, unless it has to be decompressed first
+		FileView file;
+		if (!Lz::map(_platform, path, location, file)) return false;
+		if (!Pack::isPack(file.data, file.size)) {
+			// Mapped from the cache once it's there. Packs with problems, or ones that can't be
+			// cached, are indexed instead, and their patterns read from the file as they're played.
+			if (const auto compiled = cache.store(path, location, file); compiled.data) return readPack(compiled, location, path, levels);
+		}
+
+		return readPack(file, location, path, levels);
+	}
+
+	void Load::addLevels(std::vector<std::unique_ptr<LevelFactory>>& levels) const {
+		// Packs are read as if they were the first one, so their links are moved along to
+		// where their levels end up. This is what makes external levels link correctly.
 		const auto levelIndexOffset = _game.getLevels().size();
+		for (auto& level : levels) {
+			level->offsetNextIndex(levelIndexOffset);
+			_game.addLevel(std::move(level));
+		}
 
-		if(!readCompare(stream, PROJECT_HEADER)) {
-			_platform.message(Dbg::WARN, "file", "file header invalid!");
-			return false;
+		levels.clear();
+	}
+
+	bool Load::readPack(const FileView& file, const Location location, const std::string& name, std::vector<std::unique_ptr<LevelFactory>>& levels) const {
+		if (Pack::isPack(file.data, file.size)) return readLevels(file, location, 0, _platform, name, levels, _game.getPatternPool());
+
+		// Only what the menu shows is kept, patterns are read from the file when a level is played
+		Reader reader(file.data, file.size, _platform, name.c_str());
+		return indexLevels(reader, std::make_shared<PatternLibrary>(name, location, _game.getPatternPool()), location, 0, levels);
+	}
+
+	bool Load::readLevels(const FileView& file, const Location location, const size_t levelIndexOffset, Platform& platform, const std::string& name, std::vector<std::unique_ptr<LevelFactory>>& levels, const std::shared_ptr<PatternPool>& pool) {
+		if (Pack::isPack(file.data, file.size)) {
+			const Pack pack(file, platform, name.c_str());
+			return mapLevels(pack, location, levelIndexOffset, levels, pool);
 		}
 
-		const auto numPatterns = read32(stream, 1, 300, _platform, "number of patterns");
+		Reader reader(file.data, file.size, platform, name.c_str());
+		return parseLevels(reader, location, levelIndexOffset, levels);
+	}
+
+	/**
+	 * Reads the level half of a HAX1.1 pack, after the patterns
+	 */
+	static bool readLevelTable(Reader& reader, const PatternNames& names, const Location location, const size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels) {
+		auto& platform = reader.getPlatform();
+		const auto numLevels = reader.read32(1, 300, "number of levels");
+		for (auto i = 0; i < numLevels; i++) {
+			auto level = std::make_unique<LevelFactory>(reader, names, location, levelIndexOffset);
+			if (!level->isLoaded()) {
+				platform.message(Dbg::WARN, "file", "level " + std::to_string(i) + " failed to load");
+				return false;
+			}
+
+			levels.emplace_back(std::move(level));
+		}
+
+		return reader.compare(Load::PROJECT_FOOTER, "file footer");
+	}
+
+	bool Load::parseLevels(Reader& reader, const Location location, const size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels) {
+		// Every pattern parsed (which also owns the names) and what each one is
+		// used as, since a pattern identical to an earlier one is replaced by it
+		std::vector<std::shared_ptr<PatternFactory>> parsed;
+		std::vector<std::shared_ptr<PatternFactory>> patterns;
+		std::unordered_multimap<uint64_t, size_t> hashes;
+		PatternNames names;
+		auto& platform = reader.getPlatform();
+
+		if (!reader.compare(PROJECT_HEADER, "file header")) return false;
+
+		const auto numPatterns = reader.read32(1, 300, "number of patterns");
+		parsed.reserve(numPatterns);
 		patterns.reserve(numPatterns);
+		names.reserve(numPatterns);
 		for (auto i = 0; i < numPatterns; i++) {
-			auto pattern = std::make_shared<PatternFactory>(stream, _platform);
+			auto pattern = std::make_shared<PatternFactory>(reader);
 			if (!pattern->isLoaded()) {
-				_platform.message(Dbg::WARN, "file", "a pattern failed to load");
+				platform.message(Dbg::WARN, "file", "pattern " + std::to_string(i) + " failed to load");
 				return false;
 			}
 
-			patterns.emplace_back(std::move(pattern));
+			auto same = pattern;
+			const auto hash = pattern->getHash();
+			const auto range = hashes.equal_range(hash);
+			for (auto it = range.first; it != range.second; ++it) {
+				if (patterns[it->second]->isSameAs(*pattern)) {
+					same = patterns[it->second];
+					break;
+				}
+			}
+
+			if (same == pattern) hashes.emplace(hash, patterns.size());
+			names.emplace(pattern->getName(), static_cast<uint16_t>(i));
+			patterns.emplace_back(std::move(same));
+			parsed.emplace_back(std::move(pattern));
 		}
 
 		if (patterns.empty()) {
-			_platform.message(Dbg::WARN, "file", "no patterns loaded");
+			platform.message(Dbg::WARN, "file", "no patterns loaded");
 			return false;
 		}
 
-		const auto numLevels = read32(stream, 1, 300, _platform, "number of levels");
-		for (auto i = 0; i < numLevels; i++) {
-			auto level = std::make_unique<LevelFactory>(stream, patterns, location, _platform, levelIndexOffset);
-			if (!level->isLoaded()) {
-				_platform.message(Dbg::WARN, "file", "a level failed to load");
+		const auto first = levels.size();
+		const auto loaded = readLevelTable(reader, names, location, levelIndexOffset, levels);
+		for (auto i = first; i < levels.size(); i++) levels[i]->setPatterns(patterns);
+		return loaded;
+	}
+
+	bool Load::indexLevels(Reader& reader, const std::shared_ptr<PatternLibrary>& library, const Location location, const size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels) {
+		PatternNames names;
+		auto& platform = reader.getPlatform();
+
+		if (!reader.compare(PROJECT_HEADER, "file header")) return false;
+
+		const auto numPatterns = reader.read32(1, 300, "number of patterns");
+		names.reserve(numPatterns);
+		for (auto i = 0; i < numPatterns; i++) {
+			const auto name = library->index(reader);
+			if (!reader.isOk()) {
+				platform.message(Dbg::WARN, "file", "pattern " + std::to_string(i) + " failed to index");
 				return false;
 			}
 
-			_game.addLevel(std::move(level));
+			names.emplace(name, static_cast<uint16_t>(i));
 		}
 
-		if(!readCompare(stream, PROJECT_FOOTER)) {
-			_platform.message(Dbg::WARN, "load", "file footer invalid");
-			return false;
+		const auto first = levels.size();
+		const auto loaded = readLevelTable(reader, names, location, levelIndexOffset, levels);
+		for (auto i = first; i < levels.size(); i++) levels[i]->setLibrary(library);
+		return loaded;
+	}
+
+	bool Load::streamLevels(std::istream& stream, const std::shared_ptr<PatternLibrary>& library, Platform& platform, const std::string& name, const Location location, const size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels) {
+		std::vector<uint8_t> head(6 + sizeof(uint32_t));
+		stream.read(reinterpret_cast<char*>(head.data()), static_cast<std::streamsize>(head.size()));
+		Reader reader(head.data(), static_cast<size_t>(stream.gcount()), platform, name.c_str());
+		if (!reader.compare(PROJECT_HEADER, "file header")) return false;
+
+		// The names are all that's kept of each pattern, until the levels are matched up with them
+		const auto numPatterns = reader.read32(1, MAX_STREAMED_PATTERNS, "number of patterns");
+		std::vector<std::string> patternNames(numPatterns);
+		PatternNames names;
+		names.reserve(numPatterns);
+		auto offset = head.size();
+		for (auto i = 0; i < numPatterns; i++) {
+			if (!library->index(stream, offset, platform, name.c_str(), patternNames[i])) {
+				platform.message(Dbg::WARN, "file", "pattern " + std::to_string(i) + " failed to index");
+				return false;
+			}
+
+			names.emplace(patternNames[i], static_cast<uint16_t>(i));
 		}
 
-		return true;
+		library->setStreamed(true);
+		library->close();
+
+		const auto rest = readAll(stream);
+		Reader table(rest.data(), rest.size(), platform, name.c_str());
+		const auto first = levels.size();
+		const auto loaded = readLevelTable(table, names, location, levelIndexOffset, levels);
+		for (auto i = first; i < levels.size(); i++) levels[i]->setLibrary(library);
+		return loaded;
 	}
 
-	bool Load::loadScores(std::istream& stream, uint8_t* data) const {
-		if (!stream) {
-			_platform.message(Dbg::INFO, "scores", "no score database");
-			return true;
-		}
-
-		if (!readCompare(stream, SCORE_HEADER)) {
-			_platform.message(Dbg::WARN,"scores", "score header invalid, skipping scores");
-			return true; // If there is no score database silently fail.
-		}
-		uint8_t* ptr = data + sizeof(SCORE_HEADER) + 3;
-		//uint32_t dummy; ptr = readdata(ptr, (uint8_t*)&dummy, sizeof(dummy));
-		//uint32_t dummy2; ptr = readdata(ptr, (uint8_t*)&dummy2, sizeof(dummy2));
-		uint32_t numScores; ptr = readdata(ptr, (uint8_t*)&numScores, sizeof(numScores));
-		debugf("numscores %li\n", numScores);
-		for (uint32_t i = 0; i < numScores; i++) {
-			std::string name; ptr = readdatastring(ptr, name);
-			std::string difficulty; ptr = readdatastring(ptr, difficulty);
-			std::string mode; ptr = readdatastring(ptr, mode);
-			std::string creator; ptr = readdatastring(ptr, creator);
-			int32_t score = 0; ptr = readdata(ptr, (uint8_t*)&score, sizeof(score));
-			for (const auto& level : _game.getLevels()) {
-				if (level->getName() == name && level->getDifficulty() == difficulty && level->getMode() == mode && level->getCreator() == creator) {
-					level->setHighScore(score);
-				}
-			}
+	bool Load::mapLevels(const Pack& pack, const Location location, const size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels, const std::shared_ptr<PatternPool>& pool) {
+		if (!pack.isLoaded()) return false;
+
+		const auto& header = pack.getHeader();
+		std::vector<std::shared_ptr<PatternFactory>> patterns;
+		patterns.reserve(header.patternCount);
+		for (uint32_t i = 0; i < header.patternCount; i++) {
+			const auto& pattern = pack.getPattern(i);
+			const auto* walls = pack.get<WallFactory>(pattern.walls);
+			auto mapped = std::make_shared<PatternFactory>(std::string(pack.getString(pattern.name)), pattern.sides, walls, pattern.wallCount, pack.getOwner());
+			patterns.emplace_back(pool ? pool->share(mapped) : std::move(mapped));
 		}
 
-		//if (!readCompare(stream, SCORE_FOOTER)) {
-		//	_platform.message(Dbg::WARN,"scores", "file footer invalid, db broken");
-		//	return false;
-		//}
+		levels.reserve(levels.size() + header.levelCount);
+		for (uint32_t i = 0; i < header.levelCount; i++) {
+			levels.emplace_back(std::make_unique<LevelFactory>(pack, pack.getLevel(i), patterns, location, levelIndexOffset));
+		}
 
 		return true;
 	}
 
+	void Load::embedLevels(const RomPack& pack, const Location location, const size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels) {
+		std::vector<std::shared_ptr<PatternFactory>> patterns;
+		patterns.reserve(pack.patternCount);
+		for (uint32_t i = 0; i < pack.patternCount; i++) {
+			const auto& pattern = pack.patterns[i];
+			patterns.emplace_back(std::make_shared<PatternFactory>(pattern.name, pattern.sides, pattern.walls, pattern.wallCount, nullptr));
+		}
+
+		levels.reserve(levels.size() + pack.levelCount);
+		for (uint32_t i = 0; i < pack.levelCount; i++) {
+			levels.emplace_back(std::make_unique<LevelFactory>(pack.levels[i], patterns, location, levelIndexOffset));
+		}
+	}
+
 	void Load::enter() {
-		std::vector<std::pair<Location, std::string>> levels;
-		levels.emplace_back(Location::ROM, "/levels.haxagon");
+#ifdef HAXAGON_EMBEDDED_LEVELS
+		// The built-in levels are compiled in, there's nothing to read
+		Memory::Scope scope(MemTag::LEVELS);
+		std::vector<std::unique_ptr<LevelFactory>> levels;
+		embedLevels(ROM_PACK, Location::ROM, 0, levels);
+		addLevels(levels);
+		scope.finish();
+#else
+		_packs.emplace_back(Location::ROM, "/levels.haxagon");
+#endif
+
+		_cache = std::make_unique<LevelCache>(_platform);
+		_pool = std::make_unique<WorkerPool>();
+		std::vector<std::pair<Location, std::string>> found;
+		_listed = _cache->findPacks(found);
+		_firstFound = _packs.size();
+		_packs.insert(_packs.end(), found.begin(), found.end());
+	}
 
-		auto extra_levels = _platform.loadUserLevels();
-		levels.insert(levels.end(), extra_levels.begin(), extra_levels.end());
+	std::unique_ptr<State> Load::update(const float dilation) {
+		_rotation += ROTATION_SPEED * dilation;
 
-		for (const auto& pair : levels) {
-			const auto& path = pair.second;
-			const auto location = pair.first;
-			auto file = _platform.openFile(path, location);
-			if (!file) continue;
-			loadLevels(*file, location);
+		// Nothing is loaded until the load screen is up, so boot isn't a black screen
+		if (!_drawn) {
+			_drawn = true;
+			return nullptr;
 		}
 
-		if (_game.getLevels().empty()) {
-			_platform.message(Dbg::FATAL, "levels", "no levels loaded");
-			return;
-		}
+		const auto start = getCurrentTime();
+		const auto inBudget = [&] {return (getCurrentTime() - start) * 1000.0 < SLICE_BUDGET;};
 
-		//std::ifstream scores(_platform.getPath("/scores.db", Location::USER), std::ios::in | std::ios::binary);
-		debugf( "Reading '%s'\n", "/scores.db" );
-		uint8_t* eepromfile = (uint8_t*)malloc(500);
-		memset(eepromfile, 0, (size_t)500);
-		
-		const int result = eepfs_read("/scores.db", eepromfile, (size_t)500);
-		if(result != EEPFS_ESUCCESS) debugf("eeprom file read unsuccessful\n");
+		// Fonts and the menu's sounds first, it needs them as soon as it's up.
+		// At least one thing is loaded a frame, so a slow platform still gets there.
+		auto assets = _game.loadNextAsset(true);
+		while (assets && inBudget()) assets = _game.loadNextAsset(true);
+		if (assets) return nullptr;
 
-		for(int i = 0; i < 500; i++){
-			debugf("%x", eepromfile[i]);
-		} debugf("\n");
+		Memory::Scope scope(MemTag::LEVELS);
+		do {
+			loadBatch();
+		} while (_next < _packs.size() && inBudget());
 
-		memstream stream(eepromfile, (size_t)500);
-		if (!loadScores(stream, eepromfile)) return;
-		free(eepromfile);
+		scope.finish();
+		if (_next < _packs.size()) return nullptr;
 
-		_loaded = true;
-	}
+		// Next boot skips the directory walk, unless a pack failed and might be fixed by then
+		if (!_listed && !_failed) _cache->storePacks({_packs.begin() + static_cast<std::ptrdiff_t>(_firstFound), _packs.end()});
 
-	std::unique_ptr<State> Load::update(float) {
-		if (_loaded) return std::make_unique<Menu>(_game, *_game.getLevels()[0]);
+		log<Dbg::INFO>(_platform, "load", [&] {return "levels ready " + std::to_string(static_cast<int>(_game.getRecorder().getTimeSinceStart())) + "ms after start";});
+		if (readScores()) return std::make_unique<Menu>(_game, *_game.getLevels()[0]);
 		return std::make_unique<Quit>(_game);
 	}
+
+	void Load::drawTop(const float scale) {
+		const auto focus = _game.getScreenCenter();
+		const auto progress = _packs.empty() ? 1.0f : static_cast<float>(_next) / static_cast<float>(_packs.size());
+		const auto size = SCALE_HEX_LENGTH * SCALE_MENU * scale;
+
+		// The hexagon fills in from the middle as packs are loaded
+		_game.drawBackground(COLOR_BLACK, BACKGROUND, focus, 1.5f, _rotation, 6.0f);
+		_game.drawRegular(COLOR_GREY, focus, size, _rotation, 6.0f);
+		_game.drawRegular(COLOR_BLACK, focus, (SCALE_HEX_LENGTH - SCALE_HEX_BORDER / 2) * SCALE_MENU * scale, _rotation, 6.0f);
+		if (progress > 0.0f) _game.drawRegular(COLOR_WHITE, focus, (SCALE_HEX_LENGTH - SCALE_HEX_BORDER) * SCALE_MENU * scale * progress, _rotation, 6.0f);
+	}
+
+	void Load::loadBatch() {
+		// As many packs as there are cores are read at once, then added in the
+		// order they were found, so every level gets the same index as always
+		const auto count = std::min(_pool->getWorkers(), _packs.size() - _next);
+		std::vector<std::vector<std::unique_ptr<LevelFactory>>> packs(count);
+		std::vector<uint8_t> loaded(count);
+		std::vector<JobReport> reports;
+		_pool->run(count, [&](const size_t i) {
+			const auto& pack = _packs[_next + i];
+			loaded[i] = loadLevels(*_cache, pack.second, pack.first, packs[i]);
+		}, reports);
+
+		for (size_t i = 0; i < count; i++) {
+			const auto& path = _packs[_next + i].second;
+			const auto levels = packs[i].size();
+			sendMessages(_platform, reports[i]);
+			if (reports[i].failed) _platform.message(Dbg::WARN, "load", path + ": " + reports[i].error);
+			if (loaded[i]) log<Dbg::INFO>(_platform, "load", [&] {return path + ": " + std::to_string(levels) + " levels";});
+			else log<Dbg::WARN>(_platform, "load", [&] {return path + ": failed, kept the " + std::to_string(levels) + " levels before the problem";});
+			if (!loaded[i]) _failed = true;
+			addLevels(packs[i]);
+		}
+
+		_next += count;
+	}
+
+	bool Load::readScores() const {
+		if (_game.getLevels().empty()) {
+			_platform.message(Dbg::FATAL, "levels", "no levels loaded");
+			return false;
+		}
+
+		// Levels without a saved score start from nothing, that's no reason to stop
+		_game.getScores().read(_game.getLevels());
+		Memory::report(_platform);
+		return true;
+	}
 }
@@ -5,34 +5,122 @@
 
 #include "Core/Structs.hpp"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace SuperHaxagon {
 	enum class Location;
 	class Game;
+	class LevelCache;
+	class LevelFactory;
+	class Pack;
+	class PatternLibrary;
+	class PatternPool;
 	class Platform;
+	class Reader;
+	class WorkerPool;
+	struct FileView;
+	struct RomPack;
 
 	class Load : public State {
 	public:
 		static const char* PROJECT_HEADER;
 		static const char* PROJECT_FOOTER;
-		static const char* SCORE_HEADER;
-		static const char* SCORE_FOOTER;
+
+		// Milliseconds of loading done each frame, the rest is left for drawing
+		static constexpr float SLICE_BUDGET = 8.0f;
+		static constexpr float ROTATION_SPEED = TAU / 240.0f;
+
+		// HAX1.1 packs bigger than this are streamed, their walls stay in the file
+		static constexpr uint64_t STREAM_SIZE = 256 * 1024;
+
+		// Only an index entry per pattern is kept for those, so they can have more
+		static constexpr int MAX_STREAMED_PATTERNS = 4096;
 
 		explicit Load(Game& game);
 		Load(Load&) = delete;
 		~Load() override;
 
-		bool loadLevels(std::istream& stream, Location location) const;
-		bool loadScores(std::istream& stream, uint8_t* data) const;
+		bool loadLevels(std::istream& stream, Location location, const std::string& name) const;
+
+		/**
+		 * Reads a pack from its cached, already compiled form when there is an
+		 * up to date one, otherwise from the file (caching it for next time).
+		 * The levels aren't added to the game, so several packs can be read at
+		 * once, they're handed to addLevels afterwards.
+		 */
+		bool loadLevels(const LevelCache& cache, const std::string& path, Location location, std::vector<std::unique_ptr<LevelFactory>>& levels) const;
+
+		/**
+		 * Adds the levels of a pack, read as if it were the first, to the game
+		 */
+		void addLevels(std::vector<std::unique_ptr<LevelFactory>>& levels) const;
+
+		/**
+		 * Loads either kind of level pack without adding it to the game.
+		 * HAX2 patterns are shared with identical ones in pool, if there is one.
+		 */
+		static bool readLevels(const FileView& file, Location location, size_t levelIndexOffset, Platform& platform, const std::string& name, std::vector<std::unique_ptr<LevelFactory>>& levels, const std::shared_ptr<PatternPool>& pool = nullptr);
+
+		/**
+		 * Parses a HAX1.1 level pack without adding it to the game. Levels that loaded
+		 * before an error are still handed back.
+		 */
+		static bool parseLevels(Reader& reader, Location location, size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels);
+
+		/**
+		 * Reads only the level headers of a HAX1.1 pack. Patterns are indexed into
+		 * library and read from the file when a level is played.
+		 */
+		static bool indexLevels(Reader& reader, const std::shared_ptr<PatternLibrary>& library, Location location, size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels);
+
+		/**
+		 * Indexes a HAX1.1 pack through a stream, so only one pattern is ever in
+		 * memory. The library streams, levels read each pattern as they pick it.
+		 */
+		static bool streamLevels(std::istream& stream, const std::shared_ptr<PatternLibrary>& library, Platform& platform, const std::string& name, Location location, size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels);
+
+		/**
+		 * Creates levels from a HAX2 pack. Walls stay in the pack's buffer,
+		 * unless pool already has the same pattern from another pack.
+		 */
+		static bool mapLevels(const Pack& pack, Location location, size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels, const std::shared_ptr<PatternPool>& pool = nullptr);
+
+		/**
+		 * Creates levels from tables compiled into the game. Walls and colors
+		 * stay where they are, in read-only memory.
+		 */
+		static void embedLevels(const RomPack& pack, Location location, size_t levelIndexOffset, std::vector<std::unique_ptr<LevelFactory>>& levels);
 
 		std::unique_ptr<State> update(float dilation) override;
 		void enter() override;
-		void drawTop(float) override {};
+		void drawTop(float scale) override;
 		void drawBot(float) override {};
+		const char* getName() const override {return "load";}
 
 	private:
+		/**
+		 * Reads the next few packs, one for each core
+		 */
+		void loadBatch();
+		bool readScores() const;
+		bool readPack(const FileView& file, Location location, const std::string& name, std::vector<std::unique_ptr<LevelFactory>>& levels) const;
+
 		Game& _game;
 		Platform& _platform;
-		bool _loaded = false;
+
+		// Every pack to load and how many have been
+		std::vector<std::pair<Location, std::string>> _packs;
+		std::unique_ptr<LevelCache> _cache;
+		std::unique_ptr<WorkerPool> _pool; // Reads them, its threads last as long as the load
+		size_t _next = 0;
+		size_t _firstFound = 0; // Packs from here on were found in the directory
+		bool _listed = false;   // If they came from the cache's manifest
+		bool _failed = false;
+
+		float _rotation = 0;
+		bool _drawn = false;
 	};
 }
 
@@ -38,6 +38,11 @@ namespace SuperHaxagon {
 	}
 
 	std::unique_ptr<State> Menu::update(const float dilation) {
+		// The sounds the load screen left for later and the score blocks the
+		// game over didn't get to, one of each a frame
+		_game.loadNextAsset();
+		_game.stepScores();
+
 		const auto press = _platform.getPressed();
 
 		if (press.quit) return std::make_unique<Quit>(_game);
@@ -45,6 +50,11 @@ namespace SuperHaxagon {
 		if (!_transitionDirection) {
 			if (press.select) {
 				auto& level = **_selected;
+				if (!_game.loadPatterns(level)) {
+					_game.playEffect(SoundEffect::OVER);
+					return nullptr;
+				}
+
 				_game.playMusic(level.getMusic(), level.getLocation(), true);
 				return std::make_unique<Play>(_game, level, level, 0.0f);
 			}
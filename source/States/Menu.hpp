@@ -27,6 +27,7 @@ namespace SuperHaxagon {
 		void drawBot(float scale) override;
 		void enter() override;
 		void exit() override {};
+		const char* getName() const override {return "menu";}
 
 	private:
 		Game& _game;
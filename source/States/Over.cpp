@@ -1,57 +1,16 @@
 #include "States/Over.hpp"
 
 #include "Core/Game.hpp"
+#include "Core/ScoreDb.hpp"
 #include "Driver/Font.hpp"
 #include "Driver/Platform.hpp"
 #include "Factories/LevelFactory.hpp"
 #include "Objects/Level.hpp"
-#include "States/Load.hpp"
 #include "States/Menu.hpp"
 #include "States/Play.hpp"
 #include "States/Quit.hpp"
 
-#include <cstring>
-#include <ostream>
-#include <fstream>
-
-#include <libdragon.h>
-
-class membuf : public std::basic_streambuf<char> {
-	public:
-	  membuf(const uint8_t *p, size_t l) {
-		setg((char*)p, (char*)p, (char*)p + l);
-	  }
-	};
-
-	class omemstream : public std::ostream {
-		public:
-		  omemstream(const uint8_t *p, size_t l) :
-			std::ostream(&_buffer),
-			_buffer(p, l) {
-			rdbuf(&_buffer);
-		  }
-		
-		private:
-		  membuf _buffer;
-		};
-
-uint8_t* writedata(uint8_t* ptr, uint8_t* src, int size){
-	int i = 0;
-	for(; i < size; i++){
-		ptr[i] = src[i];
-	}
-	return ptr + i;
-}
-
-uint8_t* writedatastring(uint8_t* ptr, const std::string& str) {
-	auto len = static_cast<uint32_t>(str.length());
-	ptr = writedata(ptr, (uint8_t*)reinterpret_cast<char*>(&len), sizeof(len));
-	ptr = writedata(ptr, (uint8_t*)str.c_str(), str.length());
-	return ptr;
-}
-
 namespace SuperHaxagon {
-
 	Over::Over(Game& game, std::unique_ptr<Level> level, LevelFactory& selected, const float score, std::string text) :
 		_game(game),
 		_platform(game.getPlatform()),
@@ -67,41 +26,14 @@ namespace SuperHaxagon {
 	void Over::enter() {
 		_game.playEffect(SoundEffect::OVER);
 
-		printf( "Writing '%s'\n", "/scores.db" );
-		uint8_t* eepromfile = (uint8_t*)malloc(500);
-		memset(eepromfile, 0, (size_t)500);
-
-		uint8_t* pos = eepromfile;
-
-		pos = writedata(pos, (uint8_t*)Load::SCORE_HEADER, strlen(Load::SCORE_HEADER));
-		auto levels = static_cast<uint32_t>(_game.getLevels().size());
-		pos = writedata(pos, (uint8_t*)reinterpret_cast<char*>(&levels), sizeof(levels));
-
-		for (const auto& lev : _game.getLevels()) {
-			pos = writedatastring(pos, lev->getName());
-			pos = writedatastring(pos, lev->getDifficulty());
-			pos = writedatastring(pos, lev->getMode());
-			pos = writedatastring(pos, lev->getCreator());
-			uint32_t highSc = lev->getHighScore();
-			pos = writedata(pos, (uint8_t*)reinterpret_cast<char*>(&highSc), sizeof(highSc));
-		}
-
-		pos = writedata(pos, (uint8_t*)Load::SCORE_FOOTER, strlen(Load::SCORE_FOOTER));
-
-		debugf( "Writing '%s'\n", "/scores.db" );
-		for(int i = 0; i < 500; i++){
-			debugf("%x", eepromfile[i]);
-		} debugf("\n");
-		
-		if(eepfs_write("/scores.db", eepromfile, (size_t)500) == EEPFS_ESUCCESS)
-			debugf("writing successful\n");
-		else debugf("writing unsuccessful\n");
-
-		free(eepromfile);
+		// Only marks the record, it's written a block a frame while the game over
+		// plays. Whatever is left when it ends is written from the menu.
+		if (_high) _game.getScores().set(_selected);
 	}
 
 	std::unique_ptr<State> Over::update(const float dilation) {
 		_frames += dilation;
+		_game.stepScores();
 		_level->rotate(GAME_OVER_ROT_SPEED, dilation);
 		_level->clamp();
 
@@ -115,6 +47,9 @@ namespace SuperHaxagon {
 		if(_frames >= FRAMES_PER_GAME_OVER) {
 			_level->clearPatterns();
 			if (press.select) {
+				// Patterns of the level may have been evicted while later levels were played
+				if (!_game.loadPatterns(_selected)) return std::make_unique<Menu>(_game, _selected);
+
 				// If the level we are playing is not the same as the index, we need to load
 				// the original music
 				if (_selected.getMusic() != _level->getLevelFactory().getMusic()) {
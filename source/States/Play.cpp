@@ -32,6 +32,13 @@ namespace SuperHaxagon {
 		if (bgm && !_factory.isCreditsLevel()) bgm->play();
 		_game.playEffect(SoundEffect::BEGIN);
 		_game.setShadowAuto(true);
+
+		// Read the linked level's patterns now rather than in the middle of the
+		// transition. If they can't be read, this level just keeps going.
+		const auto next = _factory.getNextIndex();
+		if (next >= 0 && static_cast<size_t>(next) < _game.getLevels().size()) {
+			_game.loadPatterns(*_game.getLevels()[next]);
+		}
 	}
 
 	void Play::exit() {
@@ -58,10 +65,11 @@ namespace SuperHaxagon {
 			const auto time = bgm ? bgm->getTime() : 0.0f;
 
 			// Apply effects. More can be added here if needed.
-			if (metadata.getMetadata(time, "S")) _level->spin();
-			if (metadata.getMetadata(time, "I")) _level->invertBG();
-			if (metadata.getMetadata(time, "BL")) _level->pulse(1.1f);
-			if (metadata.getMetadata(time, "BS")) _level->pulse(0.7f);
+			const auto beats = metadata.advance(time);
+			if (beats & beatBit(Beat::SPIN)) _level->spin();
+			if (beats & beatBit(Beat::INVERT)) _level->invertBG();
+			if (beats & beatBit(Beat::PULSE_LARGE)) _level->pulse(1.1f);
+			if (beats & beatBit(Beat::PULSE_SMALL)) _level->pulse(0.7f);
 		}
 
 		// Update level
@@ -104,7 +112,8 @@ namespace SuperHaxagon {
 		const auto next = _factory.getNextIndex();
 		if (next >= 0 && 
 		    static_cast<size_t>(next) < _game.getLevels().size() && 
-		    _level->getFrame() > 60.0f * _level->getLevelFactory().getNextTime()) {
+		    _level->getFrame() > 60.0f * _level->getLevelFactory().getNextTime() &&
+		    _game.getLevels()[next]->hasPatterns()) {
 			return std::make_unique<Transition>(_game, std::move(_level), _selected, _score);
 		}
 
@@ -137,6 +146,8 @@ namespace SuperHaxagon {
 	void Play::drawBot(const float scale) {
 		auto& small = _game.getFontSmall();
 
+		const auto* const recordText = "NEW RECORD!";
+
 		// Makes it so the score text doesn't freak out
 		// if getWidth returns slightly different values
 		// each frame
@@ -144,6 +155,8 @@ namespace SuperHaxagon {
 			_scalePrev = scale;
 			small.setScale(scale);
 			_scoreWidth = small.getWidth("TIME: " + getTime(0));
+			_recordWidth = small.getWidth(recordText);
+			_levelUp = nullptr;
 		}
 
 		const auto pad = 3 * scale;
@@ -152,22 +165,27 @@ namespace SuperHaxagon {
 
 		// Draw the top left POINT/LINE thing
 		// Note, 400 is kind of arbitrary. Perhaps it's needed to update this later.
+		// The text only changes every few seconds, so only measure it when it does.
 		const auto* levelUp = getScoreText(static_cast<int>(_level->getFrame()), _platform.getScreenDim().x <= 400);
+		if (levelUp != _levelUp) {
+			_levelUp = levelUp;
+			_levelUpWidth = small.getWidth(levelUp);
+		}
+
 		const Point levelUpPosText = {pad, pad};
 		const Point levelUpBkgSize = {
-			small.getWidth(levelUp) + pad * 2,
+			_levelUpWidth + pad * 2,
 			small.getHeight() + pad * 2
 		};
 
 		// Clockwise, from top left
-		const std::vector<Point> levelUpBkg = {
-			{0, 0},
-			{levelUpBkgSize.x + levelUpBkgSize.y / 2, 0},
-			{levelUpBkgSize.x, levelUpBkgSize.y},
-			{0, levelUpBkgSize.y},
-		};
+		_levelUpBkg.resize(4);
+		_levelUpBkg[0] = {0, 0};
+		_levelUpBkg[1] = {levelUpBkgSize.x + levelUpBkgSize.y / 2, 0};
+		_levelUpBkg[2] = {levelUpBkgSize.x, levelUpBkgSize.y};
+		_levelUpBkg[3] = {0, levelUpBkgSize.y};
 
-		_platform.drawPoly(COLOR_TRANSPARENT, levelUpBkg);
+		_platform.drawPoly(COLOR_TRANSPARENT, _levelUpBkg);
 		small.draw(COLOR_WHITE, levelUpPosText, Alignment::LEFT, levelUp);
 
 		// Draw the current score
@@ -184,7 +202,6 @@ namespace SuperHaxagon {
 		const auto highScore = static_cast<float>(_selected.getHighScore());
 
 		// Adjust background size to accommodate for new record or bar
-		const auto* const recordText = "NEW RECORD!";
 		if (highScore > 0) {
 			if (_score < highScore) {
 				scoreBkgSize.y += heightBar + pad;
@@ -192,22 +209,20 @@ namespace SuperHaxagon {
 			} else {
 				// Makes sure that if the "New Record" text is longer than the
 				// score then we increase its width
-				const auto recordTextWidth = small.getWidth(recordText);
 				scoreBkgSize.y += small.getHeight() + pad;
-				scoreBkgSize.x += recordTextWidth > _scoreWidth ? recordTextWidth - _scoreWidth : 0;
+				scoreBkgSize.x += _recordWidth > _scoreWidth ? _recordWidth - _scoreWidth : 0;
 				drawHigh = true;
 			}
 		}
 
 		// Clockwise, from top left
-		const std::vector<Point> scoreBkg = {
-			{screenWidth - scoreBkgSize.x - scoreBkgSize.y / 2, 0},
-			{screenWidth, 0},
-			{screenWidth, scoreBkgSize.y},
-			{screenWidth - scoreBkgSize.x, scoreBkgSize.y}
-		};
+		_scoreBkg.resize(4);
+		_scoreBkg[0] = {screenWidth - scoreBkgSize.x - scoreBkgSize.y / 2, 0};
+		_scoreBkg[1] = {screenWidth, 0};
+		_scoreBkg[2] = {screenWidth, scoreBkgSize.y};
+		_scoreBkg[3] = {screenWidth - scoreBkgSize.x, scoreBkgSize.y};
 
-		_platform.drawPoly(COLOR_TRANSPARENT, scoreBkg);
+		_platform.drawPoly(COLOR_TRANSPARENT, _scoreBkg);
 		small.draw(COLOR_WHITE, scorePosText, Alignment::LEFT, textScore);
 
 		if (drawBar) {
@@ -220,13 +235,14 @@ namespace SuperHaxagon {
 
 		if (drawHigh) {
 			auto textColor = COLOR_WHITE;
-			const Point posBest = {screenWidth - pad, originalY};
+			// Drawn left aligned from the cached width, right aligning would measure it again
+			const Point posBest = {screenWidth - pad - _recordWidth, originalY};
 			if (_score - highScore <= PULSE_TIMES * PULSE_TIME) {
 				const auto percent = getPulse(_score, PULSE_TIME, highScore);
 				textColor = interpolateColor(PULSE_LOW, PULSE_HIGH, percent);
 			}
 
-			small.draw(textColor, posBest, Alignment::RIGHT, recordText);
+			small.draw(textColor, posBest, Alignment::LEFT, recordText);
 		}
 	}
 }
@@ -3,6 +3,10 @@
 
 #include "State.hpp"
 
+#include "Core/Structs.hpp"
+
+#include <vector>
+
 namespace SuperHaxagon {
 	class Game;
 	class Level;
@@ -25,6 +29,8 @@ namespace SuperHaxagon {
 		void drawBot(float scale) override;
 		void enter() override;
 		void exit() override;
+		const char* getName() const override {return "play";}
+		const Level* getLevel() const override {return _level.get();}
 
 	private:
 		Game& _game;
@@ -33,6 +39,13 @@ namespace SuperHaxagon {
 		LevelFactory& _selected;
 		std::unique_ptr<Level> _level;
 
+		// Cached so drawing the HUD doesn't measure text or allocate every frame
+		std::vector<Point> _levelUpBkg;
+		std::vector<Point> _scoreBkg;
+		const char* _levelUp = nullptr;
+		float _levelUpWidth = 0;
+		float _recordWidth = 0;
+
 		float _scalePrev = 0;
 		float _scoreWidth = 0;
 		float _score = 0;
@@ -15,6 +15,7 @@ namespace SuperHaxagon {
 		std::unique_ptr<State> update(float) override;
 		void drawTop(float) override {}
 		void drawBot(float) override {}
+		const char* getName() const override {return "quit";}
 
 	private:
 		Game& _game;
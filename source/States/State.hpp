@@ -4,6 +4,8 @@
 #include <memory>
 
 namespace SuperHaxagon {
+	class Level;
+
 	class State {
 	public:
 		virtual ~State() = default;
@@ -13,6 +15,10 @@ namespace SuperHaxagon {
 		virtual void drawBot(float scale) = 0;
 		virtual void enter() {};
 		virtual void exit() {};
+
+		// Used by the flight recorder to describe a frame
+		virtual const char* getName() const = 0;
+		virtual const Level* getLevel() const {return nullptr;}
 	};
 }
 
@@ -24,6 +24,8 @@ namespace SuperHaxagon {
 		void drawTop(float scale) override;
 		void drawBot(float scale) override;
 		void enter() override;
+		const char* getName() const override {return "transition";}
+		const Level* getLevel() const override {return _level.get();}
 
 	private:
 		Game& _game;
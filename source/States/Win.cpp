@@ -28,6 +28,11 @@ namespace SuperHaxagon {
 			if (_game.getLevels()[i] == nullptr) return;
 		}
 
+		// The credits cycle through all of them, so their patterns are needed too
+		for (auto i = LEVEL_HARD; i <= LEVEL_VOID; i++) {
+			if (!_game.loadPatterns(*_game.getLevels()[i])) return;
+		}
+
 		const auto sides = 6;
 		std::vector<Wall> walls;
 		walls.reserve(sides);
@@ -103,8 +108,9 @@ namespace SuperHaxagon {
 		}
 
 		// Check for level transition labels
+		const auto beats = metadata.advance(time);
 		for (auto i = LEVEL_HARD; i <= LEVEL_VOID; i++) {
-			if (!metadata.getMetadata(time, "L" + std::to_string(i))) continue;
+			if (!(beats & beatBit(static_cast<Beat>(static_cast<int>(Beat::LEVEL_0) + i)))) continue;
 
 			const auto& factory = _game.getLevels()[i].get();
 			_level->setWinFactory(factory);
@@ -123,16 +129,20 @@ namespace SuperHaxagon {
 		}
 
 		// Apply effects. More can be added here if needed.
-		if (metadata.getMetadata(time, "HYPER")) {
+		if (beats & beatBit(Beat::HYPER)) {
 			_level->setWinFrame(60.0 * 60.0);
 			_level->spin();
 		}
 
-		if (metadata.getMetadata(time, "PSURROUND")) _level->getPatterns().emplace_front(*_surround);
-		if (metadata.getMetadata(time, "BL")) _level->pulse(1.0);
-		if (metadata.getMetadata(time, "BS")) _level->pulse(0.5);
-		if (metadata.getMetadata(time, "I")) _level->invertBG();
-		if (metadata.getMetadata(time, "C")) {
+		if (beats & beatBit(Beat::SURROUND)) {
+			auto& patterns = _level->getPatterns();
+			patterns.insert(patterns.begin(), *_surround);
+		}
+
+		if (beats & beatBit(Beat::PULSE_LARGE)) _level->pulse(1.0);
+		if (beats & beatBit(Beat::PULSE_SMALL)) _level->pulse(0.5);
+		if (beats & beatBit(Beat::INVERT)) _level->invertBG();
+		if (beats & beatBit(Beat::CREDITS)) {
 			_index++;
 			_timer = CREDITS_TIMER;
 			if (_index >= _credits.size()) _index = _credits.size() - 1;
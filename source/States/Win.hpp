@@ -29,6 +29,8 @@ namespace SuperHaxagon {
 		void enter() override;
 		void drawTop(float scale) override;
 		void drawBot(float scale) override;
+		const char* getName() const override {return "win";}
+		const Level* getLevel() const override {return _level.get();}
 
 	private:
 		Game& _game;
@@ -0,0 +1,212 @@
+#include "Harness.hpp"
+
+#include "Core/Lz.hpp"
+#include "Core/Metadata.hpp"
+#include "Core/Pack.hpp"
+#include "Core/Structs.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+#include "States/Load.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace SuperHaxagon;
+
+/**
+ * Bytes in memory handed out a read at a time, counting how many were asked for.
+ * Stands in for a file on the ROM, where every byte read is time on the bus.
+ */
+class CountingBuffer : public std::streambuf {
+public:
+	static constexpr size_t CHUNK = 512;
+
+	explicit CountingBuffer(const std::vector<uint8_t>& data) : _data(data) {}
+
+	size_t getRead() const {return _read;}
+
+protected:
+	int_type underflow() override {
+		if (_next >= _data.size()) return traits_type::eof();
+		auto* base = const_cast<char*>(reinterpret_cast<const char*>(_data.data()));
+		const auto chunk = std::min(CHUNK, _data.size() - _next);
+		setg(base + _next, base + _next, base + _next + chunk);
+		_next += chunk;
+		_read += chunk;
+		return traits_type::to_int_type(*gptr());
+	}
+
+	pos_type seekoff(const off_type off, const std::ios_base::seekdir dir, const std::ios_base::openmode which) override {
+		const auto position = static_cast<off_type>(_next) - (egptr() - gptr());
+		const auto target = (dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? position : static_cast<off_type>(_data.size())) + off;
+		if (target < 0 || target > static_cast<off_type>(_data.size())) return pos_type(off_type(-1));
+		_next = static_cast<size_t>(target);
+		setg(nullptr, nullptr, nullptr);
+		return pos_type(target);
+	}
+
+	pos_type seekpos(const pos_type pos, const std::ios_base::openmode which) override {
+		return seekoff(off_type(pos), std::ios_base::beg, which);
+	}
+
+private:
+	const std::vector<uint8_t>& _data;
+	size_t _next = 0;
+	size_t _read = 0;
+};
+
+class CountingStream : private CountingBuffer, public std::istream {
+public:
+	explicit CountingStream(const std::vector<uint8_t>& data) : CountingBuffer(data), std::istream(static_cast<std::streambuf*>(this)) {}
+	using CountingBuffer::getRead;
+};
+
+struct AssetResult {
+	std::string name;
+	size_t raw;
+	size_t packed;
+	size_t rawRead;     // Bytes read to use it stored raw
+	size_t packedRead;  // Bytes read to use it compressed
+	double rawUs;       // Time to use it stored raw
+	double packedUs;    // Time to use it compressed
+};
+
+/**
+ * Runs use over the raw and compressed bytes until it has taken some time, the best pass wins
+ */
+template <typename F>
+static AssetResult measure(const std::string& name, const std::vector<uint8_t>& raw, F use) {
+	const auto packed = Lz::compress(raw.data(), raw.size());
+	AssetResult result{name, raw.size(), packed.size(), 0, 0, 1e30, 1e30};
+	for (const auto* data : {&raw, &packed}) {
+		const auto isPacked = data == &packed;
+		auto& best = isPacked ? result.packedUs : result.rawUs;
+		auto& read = isPacked ? result.packedRead : result.rawRead;
+		const auto until = benchNow() + 0.05;
+		for (auto pass = 0; pass < 5 || benchNow() < until; pass++) {
+			auto file = std::make_unique<CountingStream>(*data);
+			auto* counter = file.get();
+			const auto start = benchNow();
+			use(Lz::open(std::move(file)), counter);
+			best = std::min(best, (benchNow() - start) * 1e6);
+			read = counter->getRead();
+		}
+	}
+
+	return result;
+}
+
+int main(const int argc, char** argv) {
+	std::string format = "table";
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg.compare(0, 9, "--format=") == 0) {
+			format = arg.substr(9);
+			continue;
+		}
+
+		std::cerr << "usage: assets [--format=table|csv|json]" << std::endl;
+		return 2;
+	}
+
+	Platform platform;
+	std::vector<AssetResult> results;
+	const auto rom = platform.getPath("", Location::ROM);
+
+	const auto pack = readAll(*platform.openFile("/levels.haxagon", Location::ROM));
+	if (pack.empty()) {
+		platform.message(Dbg::FATAL, "assets", "cannot read /levels.haxagon, set HAXAGON_ROM to the assets folder");
+		return 1;
+	}
+
+	const auto loadPack = [&](std::unique_ptr<std::istream> file, CountingStream*) {
+		std::vector<std::unique_ptr<LevelFactory>> levels;
+		keep(Load::readLevels(std::make_shared<const std::vector<uint8_t>>(readAll(*file)), Location::ROM, 0, platform, "/levels.haxagon", levels));
+	};
+
+	results.push_back(measure("levels.haxagon", pack, loadPack));
+
+	std::vector<std::unique_ptr<LevelFactory>> levels;
+	Load::readLevels(std::make_shared<const std::vector<uint8_t>>(pack), Location::ROM, 0, platform, "/levels.haxagon", levels);
+	std::ostringstream compiled;
+	Pack::write(compiled, levels, __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+	const auto compiledStr = compiled.str();
+	results.push_back(measure("levels.haxagon (HAX2)", std::vector<uint8_t>(compiledStr.begin(), compiledStr.end()), loadPack));
+
+	std::vector<std::filesystem::path> maps;
+	for (const auto& entry : std::filesystem::directory_iterator(rom + "/bgm")) {
+		if (entry.path().extension() == ".txt") maps.push_back(entry.path());
+	}
+
+	std::sort(maps.begin(), maps.end());
+	for (const auto& path : maps) {
+		std::ifstream file(path, std::ios::in | std::ios::binary);
+		results.push_back(measure("bgm/" + path.filename().string(), readAll(file), [](std::unique_ptr<std::istream> stream, CountingStream*) {
+			Metadata metadata(std::move(stream));
+			keep(metadata.getMaxTime());
+		}));
+	}
+
+	AssetResult total{"total", 0, 0, 0, 0, 0, 0};
+	for (const auto& r : results) {
+		total.raw += r.raw;
+		total.packed += r.packed;
+		total.rawRead += r.rawRead;
+		total.packedRead += r.packedRead;
+		total.rawUs += r.rawUs;
+		total.packedUs += r.packedUs;
+	}
+
+	results.push_back(total);
+
+	// Decoding alone, read straight to the end
+	const auto packed = Lz::compress(pack.data(), pack.size());
+	auto decodeUs = 1e30;
+	for (auto pass = 0; pass < 20; pass++) {
+		const auto start = benchNow();
+		auto file = Lz::open(std::make_unique<CountingStream>(packed));
+		keep(readAll(*file).size());
+		decodeUs = std::min(decodeUs, (benchNow() - start) * 1e6);
+	}
+
+	const auto decodeMBs = pack.size() / decodeUs;
+	const auto decoderBytes = 2 * Lz::WINDOW + 512;
+
+	char line[200];
+	if (format == "csv") {
+		std::cout << "asset,raw_bytes,lz_bytes,raw_read,lz_read,raw_us,lz_us\n";
+		for (const auto& r : results) {
+			snprintf(line, sizeof(line), "%s,%zu,%zu,%zu,%zu,%.1f,%.1f\n", r.name.c_str(), r.raw, r.packed, r.rawRead, r.packedRead, r.rawUs, r.packedUs);
+			std::cout << line;
+		}
+	} else if (format == "json") {
+		snprintf(line, sizeof(line), "{\"decode_mb_s\":%.1f,\"decoder_bytes\":%zu,\"results\":[", decodeMBs, decoderBytes);
+		std::cout << line;
+		for (size_t i = 0; i < results.size(); i++) {
+			const auto& r = results[i];
+			std::cout << (i ? ",\n{\"asset\":" : "\n{\"asset\":");
+			writeJsonString(std::cout, r.name);
+			snprintf(line, sizeof(line), ",\"raw_bytes\":%zu,\"lz_bytes\":%zu,\"raw_read\":%zu,\"lz_read\":%zu,\"raw_us\":%.1f,\"lz_us\":%.1f}", r.raw, r.packed, r.rawRead, r.packedRead, r.rawUs, r.packedUs);
+			std::cout << line;
+		}
+
+		std::cout << "\n]}\n";
+	} else {
+		snprintf(line, sizeof(line), "%-28s %9s %9s %6s %9s %9s %9s %9s\n", "asset", "raw KiB", "lz KiB", "ratio", "raw read", "lz read", "raw us", "lz us");
+		std::cout << line;
+		for (const auto& r : results) {
+			snprintf(line, sizeof(line), "%-28s %9.1f %9.1f %5.0f%% %9.1f %9.1f %9.1f %9.1f\n", r.name.c_str(), r.raw / 1024.0, r.packed / 1024.0,
+				100.0 * r.packed / std::max<size_t>(r.raw, 1), r.rawRead / 1024.0, r.packedRead / 1024.0, r.rawUs, r.packedUs);
+			std::cout << line;
+		}
+
+		snprintf(line, sizeof(line), "decode %.1f MB/s, decoder uses %.1f KiB at most\n", decodeMBs, decoderBytes / 1024.0);
+		std::cout << line;
+	}
+
+	return 0;
+}
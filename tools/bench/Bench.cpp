@@ -0,0 +1,227 @@
+#include "Harness.hpp"
+
+#include "Core/Game.hpp"
+#include "Core/Metadata.hpp"
+#include "Core/Pack.hpp"
+#include "Core/Reader.hpp"
+#include "Core/Structs.hpp"
+#include "Core/Twist.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+#include "Factories/PatternFactory.hpp"
+#include "Factories/PatternLibrary.hpp"
+#include "Objects/Level.hpp"
+#include "States/Load.hpp"
+#include "haxgen/Generator.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace SuperHaxagon;
+
+int main(const int argc, char** argv) {
+	Bench bench(argc, argv);
+	if (!bench.isValid()) return 2;
+
+	Platform platform;
+	Game game(platform);
+	auto& twister = game.getTwister();
+
+	const auto pack = std::make_shared<const std::vector<uint8_t>>(readAll(*platform.openFile("/levels.haxagon", Location::ROM)));
+	std::vector<std::unique_ptr<LevelFactory>> levels;
+	if (!Load::readLevels(pack, Location::ROM, 0, platform, "/levels.haxagon", levels) || levels.empty()) {
+		platform.message(Dbg::FATAL, "bench", "cannot load /levels.haxagon, set HAXAGON_ROM to the assets folder");
+		return 1;
+	}
+
+	const auto& factory = *levels[0];
+	const auto scale = game.getScreenDimMin() / 240.0f;
+	const auto maxRenderDistance = game.getScreenDimMax() / game.getScreenDimMin() / 1.666f * 233.47f + 50.0f;
+	const auto cursorDistance = SCALE_HEX_LENGTH + SCALE_HUMAN_PADDING + SCALE_HUMAN_HEIGHT;
+	const Point focus = {320, 180};
+
+	// A spread of walls around the cursor so every branch of collision gets taken
+	std::vector<Wall> walls;
+	for (auto i = 0; i < 64; i++) {
+		walls.emplace_back(twister.rand(0.0f, 80.0f), twister.rand(4.0f, 30.0f), twister.rand(5));
+	}
+
+	size_t index = 0;
+	bench.run("Wall::collision", [&] {
+		const auto& wall = walls[index++ & 63];
+		keep(wall.collision(cursorDistance, twister.rand(TAU), TAU / 30.0f, 6));
+	});
+
+	bench.run("Wall::calcPoints", [&] {
+		keep(walls[index++ & 63].calcPoints(focus, 0.5f, 6.0f, 0.0f, scale));
+	});
+
+	auto pattern = factory.getPatterns()[0]->instantiate(twister, 100.0f);
+	auto speed = 1.0f;
+	bench.run("Pattern::advance", [&] {
+		pattern.advance(speed);
+		speed = -speed;
+	});
+
+	bench.run("Pattern::getFurthestWallDistance", [&] {
+		keep(pattern.getFurthestWallDistance());
+	});
+
+	const auto level = factory.instantiate(twister, maxRenderDistance);
+	bench.run("Level::update", [&] {
+		level->update(twister, SCALE_HEX_LENGTH, maxRenderDistance, 1.0f);
+	});
+
+	bench.run("Level::collision", [&] {
+		keep(level->collision(cursorDistance, 1.0f));
+	});
+
+	bench.run("Level::draw", [&] {
+		level->draw(game, scale, 0);
+	});
+
+	// Roughly what Play does every frame, allocations here are per frame
+	bench.run("Level frame", [&] {
+		level->update(twister, SCALE_HEX_LENGTH, maxRenderDistance, 1.0f);
+		keep(level->collision(cursorDistance, 1.0f));
+		platform.screenBegin();
+		level->draw(game, scale, 0);
+		platform.screenFinalize();
+	});
+
+	Metadata metadata(platform.openFile("/bgm/callMeKatla.txt", Location::ROM));
+	const auto maxTime = metadata.getMaxTime() + 1.0f;
+	auto time = 0.0f;
+	bench.run("Metadata::advance", [&] {
+		time += 1.0f / 60.0f;
+		if (time > maxTime) time = 0;
+		keep(metadata.advance(time));
+	});
+
+	const Color one = {0x10, 0x80, 0xF0, 0xFF};
+	const Color two = {0xF0, 0x20, 0x40, 0xFF};
+	auto percent = 0.0f;
+	bench.run("rotateColor", [&] {
+		percent += 1.0f;
+		keep(rotateColor(one, percent));
+	});
+
+	bench.run("interpolateColor", [&] {
+		percent += 0.001f;
+		if (percent > 1.0f) percent = 0;
+		keep(interpolateColor(one, two, percent));
+	});
+
+	auto score = 0.0f;
+	bench.run("getTime", [&] {
+		score += 1.0f;
+		keep(getTime(score));
+	});
+
+	bench.run("Twist::rand", [&] {
+		keep(twister.rand());
+	});
+
+	bench.run("Load levels.haxagon", [&] {
+		std::vector<std::unique_ptr<LevelFactory>> loaded;
+		keep(Load::readLevels(pack, Location::ROM, 0, platform, "/levels.haxagon", loaded));
+	});
+
+	// Boot only indexes a HAX1.1 pack, patterns are read when a level is played
+	bench.run("Index levels.haxagon", [&] {
+		std::vector<std::unique_ptr<LevelFactory>> indexed;
+		Reader reader(pack->data(), pack->size(), platform, "/levels.haxagon");
+		keep(Load::indexLevels(reader, std::make_shared<PatternLibrary>("/levels.haxagon", Location::ROM), Location::ROM, 0, indexed));
+	});
+
+	bench.run("Index levels.haxagon + play level 0", [&] {
+		std::vector<std::unique_ptr<LevelFactory>> indexed;
+		Reader reader(pack->data(), pack->size(), platform, "/levels.haxagon");
+		Load::indexLevels(reader, std::make_shared<PatternLibrary>("/levels.haxagon", Location::ROM), Location::ROM, 0, indexed);
+		keep(indexed[0]->loadPatterns(platform));
+	});
+
+	// A pack too big to keep in memory, indexed through a stream and played a pattern at a time
+	GeneratorOptions large;
+	large.patterns = 1000;
+	large.walls = 256;
+	{
+		std::ofstream file(platform.getPath("/streamed.haxagon", Location::USER), std::ios::out | std::ios::binary);
+		generatePack(file, large);
+	}
+
+	const auto stream = [&](std::vector<std::unique_ptr<LevelFactory>>& streamed) {
+		const auto library = std::make_shared<PatternLibrary>("/streamed.haxagon", Location::USER);
+		return Load::streamLevels(*platform.openFile("/streamed.haxagon", Location::USER), library, platform, "/streamed.haxagon", Location::USER, 0, streamed);
+	};
+
+	bench.run("Stream index of a 1000 pattern pack", [&] {
+		std::vector<std::unique_ptr<LevelFactory>> streamed;
+		keep(stream(streamed));
+	});
+
+	std::vector<std::unique_ptr<LevelFactory>> streamed;
+	if (stream(streamed) && streamed[0]->loadPatterns(platform)) {
+		const auto& library = streamed[0]->getLibrary();
+		uint16_t paged = 0;
+		bench.run("PatternLibrary::page from a streamed pack", [&] {
+			paged = static_cast<uint16_t>((paged + 97) % library->size());
+			keep(library->page(paged));
+		});
+	}
+
+	// The same levels compiled to HAX2, which is used in place
+	std::ostringstream compiled;
+	Pack::write(compiled, levels, __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+	const auto compiledStr = compiled.str();
+	const auto mapped = std::make_shared<const std::vector<uint8_t>>(compiledStr.begin(), compiledStr.end());
+	bench.run("Load levels.haxagon as HAX2", [&] {
+		std::vector<std::unique_ptr<LevelFactory>> loaded;
+		keep(Load::readLevels(mapped, Location::ROM, 0, platform, "/levels.haxagon", loaded));
+	});
+
+	// Getting a whole file into memory, through a stream as before and mapped
+	bench.run("Read levels.haxagon through a stream", [&] {
+		keep(readAll(*platform.openFile("/levels.haxagon", Location::ROM)).size());
+	});
+
+	bench.run("Map levels.haxagon", [&] {
+		FileView view;
+		keep(platform.mapFile("/levels.haxagon", Location::ROM, view));
+	});
+
+	bench.run("Metadata from a stream", [&] {
+		Metadata parsed(platform.openFile("/bgm/callMeKatla.txt", Location::ROM));
+		keep(parsed.getMaxTime());
+	});
+
+	bench.run("Metadata from a mapped file", [&] {
+		FileView view;
+		platform.mapFile("/bgm/callMeKatla.txt", Location::ROM, view);
+		Metadata parsed(view.data, view.size);
+		keep(parsed.getMaxTime());
+	});
+
+	// The same beat map compiled the way haxbeat does for the N64 build
+	std::ostringstream beats;
+	metadata.write(beats);
+	const auto compiledBeats = beats.str();
+	bench.run("Metadata from a compiled beat map", [&] {
+		Metadata parsed(reinterpret_cast<const uint8_t*>(compiledBeats.data()), compiledBeats.size());
+		keep(parsed.getMaxTime());
+	});
+
+	// What the player waits for before anything is on screen: sounds, fonts and one slice of loading
+	bench.run("Boot to first frame", [&] {
+		Game booted(platform);
+		Load load(booted);
+		load.enter();
+		keep(load.update(1.0f));
+		load.drawTop(scale);
+		load.drawBot(scale);
+	});
+
+	bench.report(std::cout);
+	return 0;
+}
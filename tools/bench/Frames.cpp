@@ -0,0 +1,157 @@
+#include "Core/Allocations.hpp"
+#include "Core/Game.hpp"
+#include "Core/FlightRecorder.hpp"
+#include "Driver/Music.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+#include "Objects/Level.hpp"
+#include "States/Load.hpp"
+#include "States/Play.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace SuperHaxagon;
+
+// Sizes of the allocations made during a checked frame, the first few are shown
+static constexpr size_t MAX_SHOWN = 8;
+static size_t shown[MAX_SHOWN];
+static size_t caught = 0;
+
+static void catchAllocation(const size_t size) {
+	if (caught < MAX_SHOWN) shown[caught] = size;
+	caught++;
+}
+
+static void usage() {
+	std::cerr << "usage: frames [--frames=n]\n"
+	             "  Plays every level in levels.haxagon for n frames (default 3000) the way\n"
+	             "  Game::run does, with the HUD, beat map and music. Fails if any frame\n"
+	             "  allocates once a Play state is running. Nobody steers, so the player\n"
+	             "  dies often. The frame that dies and the first one after a restart are\n"
+	             "  state changes, not steady state, and aren't checked.\n";
+}
+
+/**
+ * One frame of Game::run with Play as the state. True if Play moved on to another state.
+ */
+static bool frame(Game& game, Platform& platform, Play& play) {
+	const auto scale = game.getScreenDimMin() / 240.0f;
+	auto& recorder = game.getRecorder();
+	recorder.beginFrame();
+	if (auto* bgm = game.getMusic()) bgm->update();
+	recorder.phase(Phase::AUDIO);
+
+	// The state Play moves on to has the level now, so nothing is drawn
+	if (play.update(1.0f)) return true;
+	recorder.phase(Phase::UPDATE);
+	recorder.phase(Phase::TRANSITION);
+
+	platform.screenBegin();
+	play.drawTop(scale);
+	recorder.phase(Phase::DRAW_TOP);
+	platform.screenSwap();
+	play.drawBot(scale);
+	recorder.phase(Phase::DRAW_BOT);
+	platform.screenFinalize();
+	recorder.phase(Phase::PRESENT);
+
+	const auto* level = play.getLevel();
+	recorder.endFrame(play.getName(), level ? level->getPatterns().size() : 0);
+	return false;
+}
+
+int main(const int argc, char** argv) {
+	auto frames = 3000;
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg.compare(0, 9, "--frames=") == 0 && std::atoi(arg.c_str() + 9) > 0) {
+			frames = std::atoi(arg.c_str() + 9);
+		} else {
+			usage();
+			return 2;
+		}
+	}
+
+	Platform platform;
+	Game game(platform);
+
+	// Booted the way the game does, so fonts, sounds and the levels are all there
+	Load load(game);
+	load.enter();
+	auto loaded = false;
+	for (auto i = 0; i < 10000 && !loaded; i++) loaded = load.update(1.0f) != nullptr;
+	if (!loaded || game.getLevels().empty()) {
+		platform.message(Dbg::FATAL, "frames", "cannot load the levels, set HAXAGON_ROM to the assets folder");
+		return 1;
+	}
+
+	auto failed = 0;
+	auto played = 0;
+	for (const auto& level : game.getLevels()) {
+		if (level->getLocation() != Location::ROM) continue;
+		if (!game.loadPatterns(*level)) {
+			platform.message(Dbg::WARN, "frames", "cannot load the patterns for " + level->getName());
+			failed++;
+			continue;
+		}
+
+		game.playMusic(level->getMusic(), level->getLocation(), true);
+
+		// A best time halfway through, so the HUD draws both the bar and the record
+		level->setHighScore(frames / 2);
+
+		auto checked = 0;
+		auto allocating = 0;
+		auto deaths = 0;
+		auto score = 0.0f;
+		caught = 0;
+		for (auto tries = 0; checked < frames && tries < frames; tries++) {
+			Play play(game, *level, *level, score);
+			play.enter();
+			auto first = true;
+			while (checked < frames) {
+				const auto before = getAllocationCount();
+				const auto caughtBefore = caught;
+				if (!first) setAllocationHook(catchAllocation);
+				const auto moved = frame(game, platform, play);
+				setAllocationHook(nullptr);
+				score += 1.0f;
+				if (moved) {
+					caught = caughtBefore;
+					deaths++;
+					break;
+				}
+
+				if (!first) {
+					checked++;
+					if (getAllocationCount() != before) allocating++;
+				}
+
+				first = false;
+			}
+
+			play.exit();
+		}
+
+		char line[256];
+		snprintf(line, sizeof(line), "%-24s %6d frames %4d deaths %6d allocating", level->getName().c_str(), checked, deaths, allocating);
+		std::cout << line;
+		for (size_t i = 0; i < std::min(caught, MAX_SHOWN); i++) std::cout << (i ? ", " : " (bytes: ") << shown[i] << (i + 1 == std::min(caught, MAX_SHOWN) ? ")" : "");
+		std::cout << std::endl;
+
+		if (allocating || checked < frames) failed++;
+		played++;
+	}
+
+	if (!played) {
+		platform.message(Dbg::FATAL, "frames", "levels.haxagon has no levels");
+		return 1;
+	}
+
+	std::cout << (failed ? "FAIL: " : "ok: ") << played << " levels, " << failed << " failed" << std::endl;
+	return failed ? 1 : 0;
+}
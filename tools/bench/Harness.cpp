@@ -0,0 +1,149 @@
+#include "Harness.hpp"
+
+#include "Core/Allocations.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+namespace SuperHaxagon {
+	double benchNow() {
+		const auto time = std::chrono::steady_clock::now().time_since_epoch();
+		return std::chrono::duration<double>(time).count();
+	}
+
+	void writeJsonString(std::ostream& out, const std::string& str) {
+		out << '"';
+		for (const auto c : str) {
+			if (c == '"' || c == '\\') out << '\\';
+			out << c;
+		}
+
+		out << '"';
+	}
+
+	static bool option(const std::string& arg, const std::string& name, std::string& value) {
+		if (arg.compare(0, name.size(), name) != 0) return false;
+		value = arg.substr(name.size());
+		return true;
+	}
+
+	Bench::Bench(const int argc, char** argv) {
+		for (auto i = 1; i < argc; i++) {
+			const std::string arg = argv[i];
+			std::string value;
+			if (option(arg, "--format=", value)) {
+				if (value == "table") _format = Format::TABLE;
+				else if (value == "csv") _format = Format::CSV;
+				else if (value == "json") _format = Format::JSON;
+				else _valid = false;
+			} else if (option(arg, "--filter=", value)) {
+				_filter = value;
+			} else if (option(arg, "--samples=", value)) {
+				_samples = std::max(2, std::atoi(value.c_str()));
+			} else if (option(arg, "--time=", value)) {
+				_target = std::max(0.1, std::atof(value.c_str())) / 1000.0;
+			} else if (arg == "--list") {
+				_list = true;
+			} else {
+				_valid = false;
+			}
+
+			if (!_valid) std::cerr << "unknown argument: " << arg << std::endl;
+		}
+	}
+
+	bool Bench::wants(const std::string& name) const {
+		return _filter.empty() || name.find(_filter) != std::string::npos;
+	}
+
+	void Bench::add(const BenchResult& result) {
+		if (!wants(result.name)) return;
+		_results.push_back(result);
+	}
+
+	void Bench::measure(const std::string& name, const std::function<void(size_t)>& batch) {
+		if (!wants(name)) return;
+		if (_list) {
+			std::cout << name << std::endl;
+			return;
+		}
+
+		// Calibrate, which doubles as the warmup
+		size_t iterations = 1;
+		for (;;) {
+			const auto start = benchNow();
+			batch(iterations);
+			const auto elapsed = benchNow() - start;
+			if (elapsed >= _target || iterations >= (static_cast<size_t>(1) << 30)) break;
+			iterations *= elapsed > _target / 16 ? 2 : 8;
+		}
+
+		const auto allocsBefore = getAllocationCount();
+		batch(iterations);
+		const auto allocs = getAllocationCount() - allocsBefore;
+
+		std::vector<double> times;
+		times.reserve(_samples);
+		for (size_t i = 0; i < _samples; i++) {
+			const auto start = benchNow();
+			batch(iterations);
+			times.push_back((benchNow() - start) * 1e9 / static_cast<double>(iterations));
+		}
+
+		BenchResult result{};
+		result.name = name;
+		result.iterations = iterations;
+		result.samples = _samples;
+		result.min = *std::min_element(times.begin(), times.end());
+		result.max = *std::max_element(times.begin(), times.end());
+		for (const auto time : times) result.mean += time;
+		result.mean /= static_cast<double>(times.size());
+		for (const auto time : times) result.stddev += (time - result.mean) * (time - result.mean);
+		result.stddev = std::sqrt(result.stddev / static_cast<double>(times.size() - 1));
+		result.allocs = static_cast<double>(allocs) / static_cast<double>(iterations);
+		_results.push_back(result);
+
+		// Progress goes to stderr so stdout stays machine readable
+		if (_format != Format::TABLE) std::cerr << "done " << name << std::endl;
+	}
+
+	void Bench::report(std::ostream& out) const {
+		if (_list) return;
+		char line[256];
+		switch (_format) {
+		case Format::TABLE:
+			snprintf(line, sizeof(line), "%-36s %12s %10s %12s %12s %10s\n", "benchmark", "mean ns/op", "stddev", "min", "max", "allocs/op");
+			out << line;
+			for (const auto& r : _results) {
+				snprintf(line, sizeof(line), "%-36s %12.1f %9.1f%% %12.1f %12.1f %10.2f\n", r.name.c_str(), r.mean, r.mean > 0 ? r.stddev / r.mean * 100.0 : 0.0, r.min, r.max, r.allocs);
+				out << line;
+			}
+
+			break;
+		case Format::CSV:
+			out << "name,iterations,samples,mean_ns,stddev_ns,min_ns,max_ns,allocs_per_op\n";
+			for (const auto& r : _results) {
+				snprintf(line, sizeof(line), ",%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.4f\n", r.iterations, r.samples, r.mean, r.stddev, r.min, r.max, r.allocs);
+				out << '"' << r.name << '"' << line;
+			}
+
+			break;
+		case Format::JSON:
+			out << "{\"unit\":\"ns/op\",\"benchmarks\":[";
+			for (size_t i = 0; i < _results.size(); i++) {
+				const auto& r = _results[i];
+				out << (i ? ",\n" : "\n") << "{\"name\":";
+				writeJsonString(out, r.name);
+				snprintf(line, sizeof(line), ",\"iterations\":%zu,\"samples\":%zu,\"mean\":%.3f,\"stddev\":%.3f,\"min\":%.3f,\"max\":%.3f,\"allocs\":%.4f}", r.iterations, r.samples, r.mean, r.stddev, r.min, r.max, r.allocs);
+				out << line;
+			}
+
+			out << "\n]}\n";
+			break;
+		}
+	}
+}
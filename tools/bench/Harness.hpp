@@ -0,0 +1,96 @@
+#ifndef SUPER_HAXAGON_HARNESS_HPP
+#define SUPER_HAXAGON_HARNESS_HPP
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace SuperHaxagon {
+	struct BenchResult {
+		std::string name;
+		size_t iterations; // Operations per sample
+		size_t samples;
+		double mean;       // ns/op
+		double stddev;     // ns/op
+		double min;        // ns/op
+		double max;        // ns/op
+		double allocs;     // Allocations per operation
+	};
+
+	/**
+	 * Keeps the compiler from throwing away a value that is never read
+	 */
+	template <typename T>
+	inline void keep(const T& value) {
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	/**
+	 * Tiny benchmark runner. Every case is calibrated until a sample takes
+	 * a few milliseconds, warmed up, then sampled to get a mean and spread.
+	 *
+	 * Options:
+	 *   --format=table|csv|json  Output format (default table)
+	 *   --filter=text            Only run cases whose name contains text
+	 *   --samples=n              Samples per case (default 15)
+	 *   --time=ms                Target time of one sample (default 5)
+	 *   --list                   Print case names without running them
+	 */
+	class Bench {
+	public:
+		enum class Format {
+			TABLE,
+			CSV,
+			JSON
+		};
+
+		Bench(int argc, char** argv);
+
+		/**
+		 * False if the arguments could not be understood
+		 */
+		bool isValid() const {return _valid;}
+
+		/**
+		 * Measures op, which performs a single operation per call
+		 */
+		template <typename F>
+		void run(const std::string& name, F op) {
+			measure(name, [&op](const size_t iterations) {
+				for (size_t i = 0; i < iterations; i++) op();
+			});
+		}
+
+		/**
+		 * Adds a result measured some other way (for example, a one-shot load)
+		 */
+		void add(const BenchResult& result);
+
+		bool wants(const std::string& name) const;
+		void report(std::ostream& out) const;
+
+		const std::vector<BenchResult>& getResults() const {return _results;}
+
+	private:
+		void measure(const std::string& name, const std::function<void(size_t)>& batch);
+
+		std::vector<BenchResult> _results;
+		std::string _filter;
+		Format _format = Format::TABLE;
+		size_t _samples = 15;
+		double _target = 0.005;
+		bool _list = false;
+		bool _valid = true;
+	};
+
+	/**
+	 * Seconds from a monotonic clock
+	 */
+	double benchNow();
+
+	void writeJsonString(std::ostream& out, const std::string& str);
+}
+
+#endif //SUPER_HAXAGON_HARNESS_HPP
@@ -0,0 +1,133 @@
+#include "Harness.hpp"
+
+#include "Core/Memory.hpp"
+#include "Core/Reader.hpp"
+#include "Core/Structs.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+#include "Factories/PatternLibrary.hpp"
+#include "States/Load.hpp"
+#include "haxgen/Generator.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+
+using namespace SuperHaxagon;
+
+/**
+ * A big install of user packs that ship some of the same patterns, loaded
+ * once with a pattern pool per pack and once with one pool for all of them.
+ */
+struct MultiPackResult {
+	const char* pool;
+	double indexMs;
+	double loadMs;
+	size_t patternBytes;
+};
+
+static bool option(const std::string& arg, const std::string& name, int& value) {
+	if (arg.compare(0, name.size(), name) != 0) return false;
+	value = std::atoi(arg.c_str() + name.size());
+	return true;
+}
+
+static MultiPackResult measure(Platform& platform, const std::vector<std::string>& paths, const bool sharePool) {
+	MultiPackResult result{sharePool ? "shared" : "per pack", 0, 0, 0};
+	const auto pool = std::make_shared<PatternPool>();
+
+	// Packs are read into memory first so only indexing is timed
+	std::vector<std::vector<uint8_t>> files;
+	for (const auto& path : paths) files.push_back(readAll(*platform.openFile(path, Location::USER)));
+
+	std::vector<std::unique_ptr<LevelFactory>> levels;
+	auto start = benchNow();
+	for (size_t i = 0; i < paths.size(); i++) {
+		Reader reader(files[i].data(), files[i].size(), platform, paths[i].c_str());
+		const auto library = std::make_shared<PatternLibrary>(paths[i], Location::USER, sharePool ? pool : nullptr);
+		Load::indexLevels(reader, library, Location::USER, levels.size(), levels);
+	}
+
+	result.indexMs = (benchNow() - start) * 1000.0;
+
+	// Every level played once, and nothing evicted
+	const auto before = Memory::getStats(MemTag::PATTERNS).current;
+	start = benchNow();
+	for (auto& level : levels) keep(level->loadPatterns(platform));
+	result.loadMs = (benchNow() - start) * 1000.0;
+	result.patternBytes = Memory::getStats(MemTag::PATTERNS).current - before;
+	return result;
+}
+
+int main(const int argc, char** argv) {
+	GeneratorOptions base;
+	base.patterns = 100;
+	base.walls = 256;
+	base.levels = 5;
+	base.shared = 50;
+	auto packs = 20;
+	std::string format = "table";
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (option(arg, "--packs=", packs)) continue;
+		if (option(arg, "--patterns=", base.patterns)) continue;
+		if (option(arg, "--walls=", base.walls)) continue;
+		if (option(arg, "--levels=", base.levels)) continue;
+		if (option(arg, "--shared=", base.shared)) continue;
+		if (arg.compare(0, 9, "--format=") == 0) {
+			format = arg.substr(9);
+			continue;
+		}
+
+		std::cerr << "usage: multipack [--packs=n] [--patterns=n] [--walls=n] [--levels=n] [--shared=n] [--format=table|csv|json]" << std::endl;
+		return 2;
+	}
+
+	Platform platform;
+	mkdir(platform.getPath("/multipack", Location::USER).c_str(), 0755);
+
+	std::vector<std::string> paths;
+	for (auto i = 0; i < packs; i++) {
+		auto options = base;
+		options.seed = static_cast<uint32_t>(i + 1);
+		paths.push_back("/multipack/pack" + std::to_string(i) + ".haxagon");
+		std::ofstream file(platform.getPath(paths.back(), Location::USER), std::ios::out | std::ios::binary);
+		generatePack(file, options);
+	}
+
+	const std::vector<MultiPackResult> results = {
+		measure(platform, paths, false),
+		measure(platform, paths, true),
+	};
+
+	char line[160];
+	if (format == "csv") {
+		std::cout << "pool,packs,patterns,shared,walls,index_ms,load_ms,pattern_bytes\n";
+		for (const auto& r : results) {
+			snprintf(line, sizeof(line), "%s,%d,%d,%d,%d,%.3f,%.3f,%zu\n", r.pool, packs, base.patterns, base.shared, base.walls, r.indexMs, r.loadMs, r.patternBytes);
+			std::cout << line;
+		}
+	} else if (format == "json") {
+		std::cout << "{\"packs\":" << packs << ",\"patterns\":" << base.patterns << ",\"shared\":" << base.shared << ",\"walls\":" << base.walls << ",\"results\":[";
+		for (size_t i = 0; i < results.size(); i++) {
+			const auto& r = results[i];
+			snprintf(line, sizeof(line), "%s\n{\"pool\":\"%s\",\"index_ms\":%.3f,\"load_ms\":%.3f,\"pattern_bytes\":%zu}", i ? "," : "", r.pool, r.indexMs, r.loadMs, r.patternBytes);
+			std::cout << line;
+		}
+
+		std::cout << "\n]}\n";
+	} else {
+		snprintf(line, sizeof(line), "%d packs of %d patterns (%d in every pack), %d walls each\n", packs, base.patterns, base.shared, base.walls);
+		std::cout << line;
+		snprintf(line, sizeof(line), "%-10s %9s %9s %13s\n", "pool", "index ms", "load ms", "patterns KiB");
+		std::cout << line;
+		for (const auto& r : results) {
+			snprintf(line, sizeof(line), "%-10s %9.3f %9.3f %13.1f\n", r.pool, r.indexMs, r.loadMs, r.patternBytes / 1024.0);
+			std::cout << line;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,197 @@
+#include "Harness.hpp"
+
+#include "Core/Allocations.hpp"
+#include "Core/Game.hpp"
+#include "Core/Pack.hpp"
+#include "Core/Reader.hpp"
+#include "Core/Twist.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+#include "Factories/PatternLibrary.hpp"
+#include "Objects/Level.hpp"
+#include "States/Load.hpp"
+#include "haxgen/Generator.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace SuperHaxagon;
+
+/**
+ * One point of the sweep. Times are the best of a few runs for loading
+ * and the mean over all frames for update/draw.
+ */
+struct ScalingResult {
+	int patterns;
+	int walls;
+	size_t packBytes;
+	size_t parsedBytes;
+	size_t levelBytes;
+	size_t mappedBytes;
+	size_t indexBytes;
+	double loadMs;
+	double mapMs;
+	double indexMs;
+	double updateNs;
+	double drawNs;
+	size_t frameAllocs;
+};
+
+static std::vector<int> parseList(const std::string& str) {
+	std::vector<int> list;
+	std::stringstream stream(str);
+	std::string item;
+	while (std::getline(stream, item, ',')) list.push_back(std::atoi(item.c_str()));
+	return list;
+}
+
+static bool option(const std::string& arg, const std::string& name, std::string& value) {
+	if (arg.compare(0, name.size(), name) != 0) return false;
+	value = arg.substr(name.size());
+	return true;
+}
+
+static ScalingResult measure(Platform& platform, Game& game, const GeneratorOptions& options, const int frames) {
+	ScalingResult result{};
+	result.patterns = options.patterns;
+	result.walls = options.walls;
+
+	std::ostringstream out;
+	generatePack(out, options);
+	const auto pack = out.str();
+	result.packBytes = pack.size();
+
+	// Best of a few loads. Bytes are what stays on the heap afterwards, which
+	// for HAX2 includes the pack itself since the walls are used in place.
+	std::vector<std::unique_ptr<LevelFactory>> levels;
+	const auto load = [&](const std::vector<uint8_t>& bytes, double& ms, size_t& resident) {
+		ms = 1e9;
+		for (auto run = 0; run < 3; run++) {
+			levels.clear();
+			const auto liveBefore = getAllocationStats().liveBytes;
+			const auto start = benchNow();
+			if (!Load::readLevels(std::make_shared<const std::vector<uint8_t>>(bytes), Location::ROM, 0, platform, "generated", levels)) {
+				platform.message(Dbg::WARN, "scaling", "generated pack failed to load");
+			}
+
+			ms = std::min(ms, (benchNow() - start) * 1000.0);
+			resident = getAllocationStats().liveBytes - liveBefore;
+		}
+	};
+
+	load(std::vector<uint8_t>(pack.begin(), pack.end()), result.loadMs, result.parsedBytes);
+
+	std::ostringstream compiled;
+	Pack::write(compiled, levels, __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__);
+	const auto compiledStr = compiled.str();
+	load(std::vector<uint8_t>(compiledStr.begin(), compiledStr.end()), result.mapMs, result.mappedBytes);
+
+	// What the game keeps at boot for a HAX1.1 pack, the patterns are only indexed
+	result.indexMs = 1e9;
+	for (auto run = 0; run < 3; run++) {
+		std::vector<std::unique_ptr<LevelFactory>> indexed;
+		const auto liveBefore = getAllocationStats().liveBytes;
+		const auto start = benchNow();
+		Reader reader(reinterpret_cast<const uint8_t*>(pack.data()), pack.size(), platform, "generated");
+		Load::indexLevels(reader, std::make_shared<PatternLibrary>("generated", Location::ROM), Location::ROM, 0, indexed);
+		result.indexMs = std::min(result.indexMs, (benchNow() - start) * 1000.0);
+		result.indexBytes = getAllocationStats().liveBytes - liveBefore;
+	}
+
+	if (levels.empty()) return result;
+
+	const auto scale = game.getScreenDimMin() / 240.0f;
+	const auto maxRenderDistance = game.getScreenDimMax() / game.getScreenDimMin() / 1.666f * 233.47f + 50.0f;
+	const auto cursorDistance = SCALE_HEX_LENGTH + SCALE_HUMAN_PADDING + SCALE_HUMAN_HEIGHT;
+	auto& twister = game.getTwister();
+	const auto level = levels[0]->instantiate(twister, maxRenderDistance);
+
+	auto update = 0.0;
+	auto draw = 0.0;
+	const auto allocsBefore = getAllocationCount();
+	for (auto frame = 0; frame < frames; frame++) {
+		auto start = benchNow();
+		level->update(twister, SCALE_HEX_LENGTH, maxRenderDistance, 1.0f);
+		keep(level->collision(cursorDistance, 1.0f));
+		update += benchNow() - start;
+
+		start = benchNow();
+		platform.screenBegin();
+		level->draw(game, scale, 0);
+		platform.screenFinalize();
+		draw += benchNow() - start;
+	}
+
+	result.frameAllocs = getAllocationCount() - allocsBefore;
+	result.levelBytes = level->getMemoryUsage();
+	result.updateNs = update * 1e9 / frames;
+	result.drawNs = draw * 1e9 / frames;
+	return result;
+}
+
+int main(const int argc, char** argv) {
+	std::vector<int> patterns = {1, 10, 50, 100, 200, 300};
+	std::vector<int> walls = {8, 64, 256, 1000};
+	GeneratorOptions base;
+	std::string format = "table";
+	auto frames = 600;
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		std::string value;
+		if (option(arg, "--patterns=", value)) patterns = parseList(value);
+		else if (option(arg, "--walls=", value)) walls = parseList(value);
+		else if (option(arg, "--sides=", value)) base.sides = std::atoi(value.c_str());
+		else if (option(arg, "--colors=", value)) base.colors = std::atoi(value.c_str());
+		else if (option(arg, "--frames=", value)) frames = std::max(1, std::atoi(value.c_str()));
+		else if (option(arg, "--format=", value)) format = value;
+		else {
+			std::cerr << "usage: scaling [--patterns=1,10,...] [--walls=8,64,...] [--sides=n] [--colors=n] [--frames=n] [--format=table|csv|json]" << std::endl;
+			return 2;
+		}
+	}
+
+	Platform platform;
+	Game game(platform);
+
+	std::vector<ScalingResult> results;
+	for (const auto p : patterns) {
+		for (const auto w : walls) {
+			auto options = base;
+			options.patterns = p;
+			options.walls = w;
+			results.push_back(measure(platform, game, options, frames));
+			std::cerr << "done " << p << "x" << w << std::endl;
+		}
+	}
+
+	// One row per point so the csv can be fed straight into a plotting tool
+	char line[256];
+	if (format == "csv") {
+		std::cout << "patterns,walls,pack_bytes,parsed_bytes,hax2_bytes,index_bytes,level_bytes,load_ms,hax2_load_ms,index_ms,update_ns,draw_ns,frame_allocs\n";
+		for (const auto& r : results) {
+			snprintf(line, sizeof(line), "%d,%d,%zu,%zu,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.1f,%.1f,%zu\n", r.patterns, r.walls, r.packBytes, r.parsedBytes, r.mappedBytes, r.indexBytes, r.levelBytes, r.loadMs, r.mapMs, r.indexMs, r.updateNs, r.drawNs, r.frameAllocs);
+			std::cout << line;
+		}
+	} else if (format == "json") {
+		std::cout << "{\"frames\":" << frames << ",\"points\":[";
+		for (size_t i = 0; i < results.size(); i++) {
+			const auto& r = results[i];
+			snprintf(line, sizeof(line), "%s\n{\"patterns\":%d,\"walls\":%d,\"pack_bytes\":%zu,\"parsed_bytes\":%zu,\"hax2_bytes\":%zu,\"index_bytes\":%zu,\"level_bytes\":%zu,\"load_ms\":%.3f,\"hax2_load_ms\":%.3f,\"index_ms\":%.3f,\"update_ns\":%.1f,\"draw_ns\":%.1f,\"frame_allocs\":%zu}", i ? "," : "", r.patterns, r.walls, r.packBytes, r.parsedBytes, r.mappedBytes, r.indexBytes, r.levelBytes, r.loadMs, r.mapMs, r.indexMs, r.updateNs, r.drawNs, r.frameAllocs);
+			std::cout << line;
+		}
+
+		std::cout << "\n]}\n";
+	} else {
+		snprintf(line, sizeof(line), "%8s %6s %9s %11s %9s %10s %10s %8s %8s %9s %10s %11s %7s\n", "patterns", "walls", "pack KiB", "parsed KiB", "HAX2 KiB", "index KiB", "level KiB", "load ms", "HAX2 ms", "index ms", "update ns", "draw ns", "allocs");
+		std::cout << line;
+		for (const auto& r : results) {
+			snprintf(line, sizeof(line), "%8d %6d %9.1f %11.1f %9.1f %10.1f %10.1f %8.3f %8.3f %9.3f %10.1f %11.1f %7zu\n", r.patterns, r.walls, r.packBytes / 1024.0, r.parsedBytes / 1024.0, r.mappedBytes / 1024.0, r.indexBytes / 1024.0, r.levelBytes / 1024.0, r.loadMs, r.mapMs, r.indexMs, r.updateNs, r.drawNs, r.frameAllocs);
+			std::cout << line;
+		}
+	}
+
+	return 0;
+}
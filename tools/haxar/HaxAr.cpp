@@ -0,0 +1,101 @@
+#include "Core/Archive.hpp"
+#include "Core/Lz.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace SuperHaxagon;
+
+static void usage() {
+	std::cerr << "usage: haxar [options] <root> <output> [files...]\n"
+	             "  Packs files under root into one asset archive, named by their path from\n"
+	             "  root (\"/bgm/screenSaver.txt\"). With no files, everything under root is packed.\n"
+	             "  --big, --little  byte order of the archive, default is this machine's (N64 is --big)\n"
+	             "  --cpp=symbol     write a C++ array called symbol (and symbol_len) instead\n"
+	             "  --lz             compress every file, the game decompresses them as it reads\n";
+}
+
+static void writeArray(std::ostream& out, const std::string& bytes, const std::string& symbol) {
+	out << "// Generated by haxar, do not edit\n\n";
+	out << "alignas(4) unsigned char " << symbol << "[] = {";
+	char hex[8];
+	for (size_t i = 0; i < bytes.size(); i++) {
+		snprintf(hex, sizeof(hex), "0x%02x,", static_cast<uint8_t>(bytes[i]));
+		out << (i % 16 == 0 ? "\n\t" : " ") << hex;
+	}
+
+	out << "\n};\n\nunsigned int " << symbol << "_len = " << bytes.size() << ";\n";
+}
+
+int main(const int argc, char** argv) {
+	auto bigEndian = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+	auto compress = false;
+	std::string symbol;
+	std::vector<std::string> paths;
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--big") bigEndian = true;
+		else if (arg == "--little") bigEndian = false;
+		else if (arg == "--lz") compress = true;
+		else if (arg.compare(0, 6, "--cpp=") == 0) symbol = arg.substr(6);
+		else if (arg.compare(0, 2, "--") != 0) paths.push_back(arg);
+		else {
+			usage();
+			return 2;
+		}
+	}
+
+	if (paths.size() < 2) {
+		usage();
+		return 2;
+	}
+
+	const std::filesystem::path root = paths[0];
+	const auto output = paths[1];
+	std::vector<std::filesystem::path> inputs(paths.begin() + 2, paths.end());
+	if (inputs.empty()) {
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+			if (entry.is_regular_file()) inputs.push_back(entry.path());
+		}
+	}
+
+	std::vector<std::pair<std::string, std::vector<uint8_t>>> files;
+	for (const auto& input : inputs) {
+		const auto relative = std::filesystem::relative(input, root);
+		if (relative.empty() || *relative.begin() == "..") {
+			std::cerr << input.string() << ": is not under " << root.string() << std::endl;
+			return 1;
+		}
+
+		std::ifstream file(input, std::ios::in | std::ios::binary);
+		if (!file) {
+			std::cerr << input.string() << ": cannot be read" << std::endl;
+			return 1;
+		}
+
+		std::vector<uint8_t> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		if (compress) contents = Lz::compress(contents.data(), contents.size());
+		files.emplace_back("/" + relative.generic_string(), std::move(contents));
+	}
+
+	std::ostringstream archive;
+	Archive::write(archive, files, bigEndian);
+
+	const auto bytes = archive.str();
+	std::ofstream out(output, std::ios::out | std::ios::binary);
+	if (symbol.empty()) out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	else writeArray(out, bytes, symbol);
+	if (!out) {
+		std::cerr << "cannot write " << output << std::endl;
+		return 1;
+	}
+
+	std::cerr << output << ": " << files.size() << " files, " << bytes.size() << " bytes" << std::endl;
+	return 0;
+}
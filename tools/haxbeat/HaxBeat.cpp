@@ -0,0 +1,75 @@
+#include "Core/Lz.hpp"
+#include "Core/Metadata.hpp"
+#include "Core/Structs.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace SuperHaxagon;
+
+static void usage() {
+	std::cerr << "usage: haxbeat <input> <output>\n"
+	             "  Compiles an Audacity label file (bgm/*.txt) into a beat map (.hxb) that the\n"
+	             "  game reads without parsing any text. Input and output can also be directories,\n"
+	             "  then every .txt in the input directory is compiled.\n";
+}
+
+static bool compile(const std::string& input, const std::string& output) {
+	auto file = Lz::open(std::make_unique<std::ifstream>(input, std::ios::in | std::ios::binary));
+	if (!*file) {
+		std::cerr << input << ": cannot be read" << std::endl;
+		return false;
+	}
+
+	const auto text = readAll(*file);
+	Metadata metadata(text.data(), text.size());
+	std::ostringstream compiled;
+	metadata.write(compiled);
+	const auto bytes = compiled.str();
+
+	std::ofstream out(output, std::ios::out | std::ios::binary);
+	out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	if (!out) {
+		std::cerr << input << ": cannot write " << output << std::endl;
+		return false;
+	}
+
+	char line[256];
+	snprintf(line, sizeof(line), "%s: %zu labels, %zu -> %zu bytes", input.c_str(), metadata.getLabelCount(), text.size(), bytes.size());
+	std::cerr << line << std::endl;
+	return true;
+}
+
+int main(const int argc, char** argv) {
+	if (argc != 3 || argv[1][0] == '-' || argv[2][0] == '-') {
+		usage();
+		return 2;
+	}
+
+	const std::string input = argv[1];
+	const std::string output = argv[2];
+	if (!std::filesystem::is_directory(input)) return compile(input, output) ? 0 : 1;
+
+	std::vector<std::filesystem::path> maps;
+	for (const auto& entry : std::filesystem::directory_iterator(input)) {
+		if (entry.path().extension() == ".txt") maps.push_back(entry.path());
+	}
+
+	std::sort(maps.begin(), maps.end());
+	std::filesystem::create_directories(output);
+	auto failed = 0;
+	for (const auto& path : maps) {
+		auto out = std::filesystem::path(output) / path.filename();
+		out.replace_extension(".hxb");
+		if (!compile(path.string(), out.string())) failed++;
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+#include "Embed.hpp"
+
+#include "Factories/LevelFactory.hpp"
+#include "Factories/PatternFactory.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace SuperHaxagon {
+	static const char* LOCATION_NAMES[COLOR_LOCATION_LAST] = {"FG", "BG1", "BG2"};
+
+	static std::string quote(const std::string& str) {
+		// Octal escapes are always three digits, so they can't run into the next character
+		std::string quoted = "\"";
+		char escape[8];
+		for (const auto c : str) {
+			const auto byte = static_cast<unsigned char>(c);
+			if (c == '"' || c == '\\' || c == '?' || byte < 0x20 || byte > 0x7E) {
+				snprintf(escape, sizeof(escape), "\\%03o", byte);
+				quoted += escape;
+			} else {
+				quoted += c;
+			}
+		}
+
+		return quoted + "\"";
+	}
+
+	static std::string number(const float value) {
+		if (std::isnan(value)) return "__builtin_nanf(\"\")";
+		if (std::isinf(value)) return value < 0 ? "-__builtin_inff()" : "__builtin_inff()";
+
+		// Enough digits that the float comes back exactly the same
+		char str[32];
+		snprintf(str, sizeof(str), "%.9g", value);
+		std::string literal = str;
+		if (literal.find_first_of(".e") == std::string::npos) literal += ".0";
+		return literal + "f";
+	}
+
+	void writeEmbeddedPack(std::ostream& out, const std::vector<std::unique_ptr<LevelFactory>>& levels, const std::string& source) {
+		// Only patterns that some level uses are kept, in the order they're first used
+		std::vector<const PatternFactory*> patterns;
+		std::map<const PatternFactory*, size_t> indices;
+		for (const auto& level : levels) {
+			for (const auto& pattern : level->getPatterns()) {
+				if (indices.emplace(pattern.get(), patterns.size()).second) patterns.push_back(pattern.get());
+			}
+		}
+
+		out << "// Generated by haxc --cpp from " << source << ", don't edit\n\n"
+		       "#include \"Core/RomPack.hpp\"\n"
+		       "#include \"Factories/WallFactory.hpp\"\n\n"
+		       "namespace SuperHaxagon {\n";
+
+		for (size_t p = 0; p < patterns.size(); p++) {
+			out << "\tstatic constexpr WallFactory WALLS_" << p << "[] = {";
+			for (size_t w = 0; w < patterns[p]->getWallCount(); w++) {
+				const auto& wall = patterns[p]->getWalls()[w];
+				out << (w % 8 ? " " : "\n\t\t") << "{" << wall.getDistance() << ", " << wall.getHeight() << ", " << wall.getSide() << "},";
+			}
+
+			out << "\n\t};\n\n";
+		}
+
+		out << "\tstatic constexpr RomPattern PATTERNS[] = {\n";
+		for (size_t p = 0; p < patterns.size(); p++) {
+			out << "\t\t{" << quote(patterns[p]->getName()) << ", " << patterns[p]->getSides() << ", " << patterns[p]->getWallCount() << ", WALLS_" << p << "},\n";
+		}
+
+		out << "\t};\n\n";
+
+		for (size_t l = 0; l < levels.size(); l++) {
+			const auto& level = *levels[l];
+			for (auto c = COLOR_LOCATION_FIRST; c != COLOR_LOCATION_LAST; c++) {
+				out << "\tstatic constexpr Color COLORS_" << l << "_" << LOCATION_NAMES[c] << "[] = {";
+				const auto& colors = level.getColors().at(static_cast<LocColor>(c));
+				for (size_t i = 0; i < colors.size(); i++) {
+					const auto& color = colors[i];
+					out << (i % 6 ? " " : "\n\t\t") << "{" << +color.r << ", " << +color.g << ", " << +color.b << ", " << +color.a << "},";
+				}
+
+				out << "\n\t};\n\n";
+			}
+
+			out << "\tstatic constexpr uint16_t LEVEL_PATTERNS_" << l << "[] = {";
+			const auto& used = level.getPatterns();
+			for (size_t i = 0; i < used.size(); i++) out << (i % 16 ? " " : "\n\t\t") << indices.at(used[i].get()) << ",";
+			out << "\n\t};\n\n";
+		}
+
+		out << "\tstatic constexpr RomLevel LEVELS[] = {\n";
+		for (size_t l = 0; l < levels.size(); l++) {
+			const auto& level = *levels[l];
+			out << "\t\t{\n"
+			    << "\t\t\t" << quote(level.getName()) << ", " << quote(level.getDifficulty()) << ", " << quote(level.getMode()) << ", " << quote(level.getCreator()) << ",\n"
+			    << "\t\t\t" << quote(level.getMusic().substr(1)) << ",\n\t\t\t{";
+			for (auto c = COLOR_LOCATION_FIRST; c != COLOR_LOCATION_LAST; c++) out << (c ? ", " : "") << level.getColors().at(static_cast<LocColor>(c)).size();
+			out << "},\n\t\t\t{";
+			for (auto c = COLOR_LOCATION_FIRST; c != COLOR_LOCATION_LAST; c++) out << (c ? ", " : "") << "COLORS_" << l << "_" << LOCATION_NAMES[c];
+			out << "},\n"
+			    << "\t\t\t" << number(level.getSpeedWall()) << ", " << number(level.getSpeedRotation()) << ", " << number(level.getSpeedCursor()) << ",\n"
+			    << "\t\t\t" << level.getSpeedPulse() << ", " << level.getNextIndex() << ", " << number(level.getNextTime()) << ",\n"
+			    << "\t\t\t" << level.getPatterns().size() << ", LEVEL_PATTERNS_" << l << "\n"
+			    << "\t\t},\n";
+		}
+
+		out << "\t};\n\n"
+		    << "\textern const RomPack ROM_PACK = {" << patterns.size() << ", PATTERNS, " << levels.size() << ", LEVELS};\n"
+		    << "}\n";
+	}
+}
@@ -0,0 +1,19 @@
+#ifndef SUPER_HAXAGON_EMBED_HPP
+#define SUPER_HAXAGON_EMBED_HPP
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace SuperHaxagon {
+	class LevelFactory;
+
+	/**
+	 * Writes levels and the patterns they use as C++ tables that define
+	 * ROM_PACK (see Core/RomPack.hpp), for building into the game.
+	 */
+	void writeEmbeddedPack(std::ostream& out, const std::vector<std::unique_ptr<LevelFactory>>& levels, const std::string& source);
+}
+
+#endif //SUPER_HAXAGON_EMBED_HPP
@@ -0,0 +1,231 @@
+#include "Embed.hpp"
+#include "Optimize.hpp"
+#include "Validate.hpp"
+
+#include "Core/Lz.hpp"
+#include "Core/Pack.hpp"
+#include "Core/Parallel.hpp"
+#include "Core/Reader.hpp"
+#include "Core/Structs.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+#include "Factories/PatternFactory.hpp"
+#include "States/Load.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+
+using namespace SuperHaxagon;
+
+struct Options {
+	bool bigEndian = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+	bool legacy = false;
+	bool embed = false;
+	bool check = false;
+	bool strict = false;
+	bool optimize = true;
+	bool compress = false;
+	bool stream = false;
+	int jobs = 0;
+};
+
+struct Job {
+	std::string input;
+	std::string output;
+};
+
+struct Result {
+	bool ok = false;
+	std::string error;
+	PackReport report{};
+	size_t levels = 0;
+	size_t patterns = 0;
+	size_t walls = 0;
+	size_t bytesIn = 0;
+	size_t bytesOut = 0;
+	bool streamed = false;
+};
+
+static void usage() {
+	std::cerr << "usage: haxc [options] <input> <output>\n"
+	             "  Checks a HAX1.1 (or HAX2) pack and compiles it into a HAX2 pack that the\n"
+	             "  game uses in place. Input and output can also be directories, then every\n"
+	             "  .haxagon in the input directory is done, several at once.\n"
+	             "  --big, --little  byte order of HAX2 output, default is this machine's (N64 is --big)\n"
+	             "  --hax1           write an optimized HAX1.1 pack instead of HAX2\n"
+	             "  --cpp            write C++ tables that build the pack into the game\n"
+	             "  --check          only report problems, nothing is written (no output needed)\n"
+	             "  --strict         don't write packs that have problems\n"
+	             "  --keep-walls     don't merge walls that overlap\n"
+	             "  --lz             compress the output, the game decompresses it as it reads\n"
+	             "  --stream         write packs the game streams as uncompressed HAX1.1, so they stay\n"
+	             "                   in the file instead of in memory (over 256 KiB as HAX1.1)\n"
+	             "  --jobs=n         packs to do at once, default is one per core\n";
+}
+
+static Result compile(const Job& job, const Options& options) {
+	Result result;
+	Platform platform;
+	auto file = Lz::open(std::make_unique<std::ifstream>(job.input, std::ios::in | std::ios::binary));
+	if (!*file) {
+		result.error = "cannot be read";
+		return result;
+	}
+
+	const auto data = std::make_shared<const std::vector<uint8_t>>(readAll(*file));
+	result.bytesIn = data->size();
+
+	// HAX2 packs are checked when they're loaded, HAX1.1 packs get the full check
+	if (!Pack::isPack(data->data(), data->size())) {
+		Reader reader(data->data(), data->size(), platform, job.input.c_str());
+		result.report = validatePack(reader);
+	}
+
+	if (options.check || (options.strict && result.report.problems > 0)) {
+		result.ok = result.report.problems == 0;
+		if (!result.ok) result.error = "has problems, nothing written";
+		return result;
+	}
+
+	std::vector<std::unique_ptr<LevelFactory>> levels;
+	if (!Load::readLevels(data, Location::ROM, 0, platform, job.input, levels)) {
+		result.error = "did not load, nothing written";
+		return result;
+	}
+
+	if (options.optimize) optimizeLevels(levels);
+
+	std::set<const PatternFactory*> patterns;
+	for (const auto& level : levels) {
+		for (const auto& pattern : level->getPatterns()) {
+			if (patterns.insert(pattern.get()).second) result.walls += pattern->getWallCount();
+		}
+	}
+
+	result.levels = levels.size();
+	result.patterns = patterns.size();
+
+	std::ostringstream compiled;
+	if (options.embed) writeEmbeddedPack(compiled, levels, std::filesystem::path(job.input).filename().string());
+	else if (options.legacy) writeLegacyPack(compiled, levels);
+	else Pack::write(compiled, levels, options.bigEndian);
+
+	auto bytes = compiled.str();
+	if (options.stream && !options.embed) {
+		std::ostringstream legacy;
+		writeLegacyPack(legacy, levels);
+		if (static_cast<uint64_t>(legacy.tellp()) > Load::STREAM_SIZE) {
+			bytes = legacy.str();
+			result.streamed = true;
+		}
+	}
+
+	if (options.compress && !options.embed && !result.streamed) {
+		const auto packed = Lz::compress(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+		bytes.assign(packed.begin(), packed.end());
+	}
+
+	std::ofstream out(job.output, std::ios::out | std::ios::binary);
+	out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	if (!out) {
+		result.error = "cannot write " + job.output;
+		return result;
+	}
+
+	result.bytesOut = bytes.size();
+	result.ok = true;
+	return result;
+}
+
+static bool option(const std::string& arg, const std::string& name, int& value) {
+	if (arg.compare(0, name.size(), name) != 0) return false;
+	value = std::atoi(arg.c_str() + name.size());
+	return true;
+}
+
+int main(const int argc, char** argv) {
+	Options options;
+	std::string input;
+	std::string output;
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		if (arg == "--big") options.bigEndian = true;
+		else if (arg == "--little") options.bigEndian = false;
+		else if (arg == "--hax1") options.legacy = true;
+		else if (arg == "--cpp") options.embed = true;
+		else if (arg == "--check") options.check = true;
+		else if (arg == "--strict") options.strict = true;
+		else if (arg == "--keep-walls") options.optimize = false;
+		else if (arg == "--lz") options.compress = true;
+		else if (arg == "--stream") options.stream = true;
+		else if (option(arg, "--jobs=", options.jobs)) continue;
+		else if (arg.compare(0, 2, "--") != 0 && input.empty()) input = arg;
+		else if (arg.compare(0, 2, "--") != 0 && output.empty()) output = arg;
+		else {
+			usage();
+			return 2;
+		}
+	}
+
+	if (input.empty() || (output.empty() && !options.check)) {
+		usage();
+		return 2;
+	}
+
+	std::vector<Job> jobs;
+	if (std::filesystem::is_directory(input)) {
+		if (!options.check) std::filesystem::create_directories(output);
+		for (const auto& entry : std::filesystem::directory_iterator(input)) {
+			if (entry.path().extension() != ".haxagon") continue;
+			const auto out = options.check ? "" : (std::filesystem::path(output) / entry.path().filename()).string();
+			jobs.push_back({entry.path().string(), out});
+		}
+
+		std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {return a.input < b.input;});
+	} else {
+		jobs.push_back({input, output});
+	}
+
+	// Packs don't share anything, so they're all done at once
+	std::vector<Result> results(jobs.size());
+	std::vector<JobReport> reports;
+	WorkerPool pool(static_cast<size_t>(std::max(options.jobs, 0)));
+	pool.run(jobs.size(), [&](const size_t i) {
+		results[i] = compile(jobs[i], options);
+	}, reports);
+
+	Platform platform;
+	auto failed = 0;
+	char line[256];
+	for (size_t i = 0; i < jobs.size(); i++) {
+		auto& r = results[i];
+		sendMessages(platform, reports[i]);
+		if (reports[i].failed) r.error = reports[i].error;
+		if (!r.ok) failed++;
+		if (!r.error.empty()) {
+			std::cerr << jobs[i].input << ": " << r.error << std::endl;
+			continue;
+		}
+
+		if (options.check) {
+			std::cerr << jobs[i].input << ": ok" << std::endl;
+			continue;
+		}
+
+		snprintf(line, sizeof(line), "%s: %zu levels, %d -> %zu patterns, %d -> %zu walls, %zu problems, %zu -> %zu bytes%s",
+			jobs[i].input.c_str(), r.levels, r.report.patterns, r.patterns, r.report.walls, r.walls, r.report.problems, r.bytesIn, r.bytesOut,
+			r.streamed ? ", streamed" : "");
+		std::cerr << line << std::endl;
+	}
+
+	if (jobs.size() > 1) std::cerr << jobs.size() - failed << " of " << jobs.size() << " packs ok" << std::endl;
+	return failed ? 1 : 0;
+}
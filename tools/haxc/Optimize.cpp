@@ -0,0 +1,135 @@
+#include "Optimize.hpp"
+
+#include "Factories/LevelFactory.hpp"
+#include "Factories/PatternFactory.hpp"
+#include "States/Load.hpp"
+
+#include <algorithm>
+#include <map>
+
+namespace SuperHaxagon {
+	static constexpr uint32_t MAX_WALL_END = 0xFFFF;
+
+	static std::shared_ptr<PatternFactory> optimizePattern(const std::shared_ptr<PatternFactory>& pattern) {
+		std::vector<WallFactory> walls(pattern->getWalls(), pattern->getWalls() + pattern->getWallCount());
+		std::sort(walls.begin(), walls.end(), [](const WallFactory& a, const WallFactory& b) {
+			return a.getSide() != b.getSide() ? a.getSide() < b.getSide() : a.getDistance() < b.getDistance();
+		});
+
+		auto merged = std::make_shared<std::vector<WallFactory>>();
+		merged->reserve(walls.size());
+		for (const auto& wall : walls) {
+			if (!merged->empty()) {
+				const auto& last = merged->back();
+				const auto lastEnd = static_cast<uint32_t>(last.getDistance()) + last.getHeight();
+				const auto end = static_cast<uint32_t>(wall.getDistance()) + wall.getHeight();
+				if (last.getSide() == wall.getSide() && wall.getDistance() <= lastEnd && std::max(lastEnd, end) <= MAX_WALL_END) {
+					const auto height = static_cast<uint16_t>(std::max(lastEnd, end) - last.getDistance());
+					merged->back() = {last.getDistance(), height, last.getSide()};
+					continue;
+				}
+			}
+
+			merged->push_back(wall);
+		}
+
+		if (merged->size() == walls.size()) return pattern;
+		const auto* data = merged->data();
+		const auto count = merged->size();
+		return std::make_shared<PatternFactory>(pattern->getName(), pattern->getSides(), data, count, std::move(merged));
+	}
+
+	size_t optimizeLevels(std::vector<std::unique_ptr<LevelFactory>>& levels) {
+		size_t removed = 0;
+		std::map<const PatternFactory*, std::shared_ptr<PatternFactory>> optimized;
+		for (auto& level : levels) {
+			for (auto& pattern : level->getPatterns()) {
+				auto found = optimized.find(pattern.get());
+				if (found == optimized.end()) {
+					auto better = optimizePattern(pattern);
+					removed += pattern->getWallCount() - better->getWallCount();
+					found = optimized.emplace(pattern.get(), std::move(better)).first;
+				}
+
+				pattern = found->second;
+			}
+		}
+
+		return removed;
+	}
+
+	static void writeLE(std::ostream& out, const uint32_t value, const int bytes) {
+		for (auto i = 0; i < bytes; i++) out.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+	}
+
+	static void writeFloat(std::ostream& out, const float value) {
+		uint32_t bits;
+		std::copy_n(reinterpret_cast<const char*>(&value), sizeof(bits), reinterpret_cast<char*>(&bits));
+		writeLE(out, bits, 4);
+	}
+
+	static void writeText(std::ostream& out, const std::string& str) {
+		writeLE(out, static_cast<uint32_t>(str.size()), 4);
+		out.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+
+	void writeLegacyPack(std::ostream& out, const std::vector<std::unique_ptr<LevelFactory>>& levels) {
+		// Only patterns that some level uses are kept, in the order they're first used
+		std::vector<const PatternFactory*> patterns;
+		for (const auto& level : levels) {
+			for (const auto& pattern : level->getPatterns()) {
+				if (std::find(patterns.begin(), patterns.end(), pattern.get()) == patterns.end()) patterns.push_back(pattern.get());
+			}
+		}
+
+		out.write(Load::PROJECT_HEADER, 6);
+		writeLE(out, static_cast<uint32_t>(patterns.size()), 4);
+		for (const auto* pattern : patterns) {
+			writeText(out, pattern->getName());
+			out.write(PatternFactory::PATTERN_HEADER, 6);
+			writeLE(out, static_cast<uint32_t>(pattern->getSides()), 4);
+			writeLE(out, static_cast<uint32_t>(pattern->getWallCount()), 4);
+			for (size_t w = 0; w < pattern->getWallCount(); w++) {
+				const auto& wall = pattern->getWalls()[w];
+				writeLE(out, wall.getDistance(), 2);
+				writeLE(out, wall.getHeight(), 2);
+				writeLE(out, wall.getSide(), 2);
+			}
+
+			out.write(PatternFactory::PATTERN_FOOTER, 6);
+		}
+
+		writeLE(out, static_cast<uint32_t>(levels.size()), 4);
+		for (const auto& level : levels) {
+			out.write(LevelFactory::LEVEL_HEADER, 6);
+			writeText(out, level->getName());
+			writeText(out, level->getDifficulty());
+			writeText(out, level->getMode());
+			writeText(out, level->getCreator());
+
+			// Music is stored without the leading slash
+			writeText(out, level->getMusic().substr(1));
+			for (const auto location : {LocColor::BG1, LocColor::BG2, LocColor::FG}) {
+				const auto& colors = level->getColors().at(location);
+				writeLE(out, static_cast<uint32_t>(colors.size()), 4);
+				for (const auto& color : colors) {
+					out.put(static_cast<char>(color.r));
+					out.put(static_cast<char>(color.g));
+					out.put(static_cast<char>(color.b));
+				}
+			}
+
+			writeFloat(out, level->getSpeedWall());
+			writeFloat(out, level->getSpeedRotation());
+			writeFloat(out, level->getSpeedCursor());
+			writeLE(out, static_cast<uint32_t>(level->getSpeedPulse()), 4);
+			writeLE(out, static_cast<uint32_t>(level->getNextIndex()), 4);
+			writeFloat(out, level->getNextTime());
+			writeLE(out, static_cast<uint32_t>(level->getPatterns().size()), 4);
+			for (const auto& pattern : level->getPatterns()) writeText(out, pattern->getName());
+			out.write(LevelFactory::LEVEL_FOOTER, 6);
+		}
+
+		out.write(Load::PROJECT_FOOTER, 6);
+	}
+}
@@ -0,0 +1,26 @@
+#ifndef SUPER_HAXAGON_OPTIMIZE_HPP
+#define SUPER_HAXAGON_OPTIMIZE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace SuperHaxagon {
+	class LevelFactory;
+
+	/**
+	 * Merges walls on the same side that overlap or touch into one wall. A
+	 * wall inside another one can never be seen, and the merged walls draw and
+	 * collide exactly like the ones they replace. Returns how many walls went.
+	 */
+	size_t optimizeLevels(std::vector<std::unique_ptr<LevelFactory>>& levels);
+
+	/**
+	 * Writes levels and the patterns they use as a HAX1.1 pack, which
+	 * every version of the game (and Haxa Editor) can read.
+	 */
+	void writeLegacyPack(std::ostream& out, const std::vector<std::unique_ptr<LevelFactory>>& levels);
+}
+
+#endif //SUPER_HAXAGON_OPTIMIZE_HPP
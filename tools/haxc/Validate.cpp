@@ -0,0 +1,101 @@
+#include "Validate.hpp"
+
+#include "Core/Reader.hpp"
+#include "Driver/Platform.hpp"
+#include "Factories/LevelFactory.hpp"
+#include "Factories/PatternFactory.hpp"
+#include "Factories/WallFactory.hpp"
+#include "States/Load.hpp"
+
+#include <cmath>
+#include <string>
+#include <unordered_set>
+
+namespace SuperHaxagon {
+	static void checkFloat(Reader& reader, const char* noun) {
+		const auto at = reader.getOffset();
+		if (!std::isfinite(reader.readFloat(noun))) reader.report(noun, "is not a number", at);
+	}
+
+	static void checkColors(Reader& reader, const char* noun, const char* colorNoun) {
+		const auto count = reader.read32(1, 512, noun);
+		for (auto i = 0; i < count && reader.isOk(); i++) reader.readColor(colorNoun);
+	}
+
+	PackReport validatePack(Reader& reader) {
+		PackReport report{};
+		const auto done = [&]() {
+			report.problems = reader.getProblems();
+			return report;
+		};
+
+		if (!reader.compare(Load::PROJECT_HEADER, "file header")) return done();
+
+		std::unordered_set<std::string> names;
+
+		report.patterns = reader.read32(1, 300, "number of patterns");
+		for (auto p = 0; p < report.patterns && reader.isOk(); p++) {
+			const auto nameAt = reader.getOffset();
+			const auto name = reader.readString("pattern name");
+			if (!names.insert(name).second) reader.report("pattern name", ("\"" + name + "\" is repeated, levels only ever use the first").c_str(), nameAt);
+			if (!reader.compare(PatternFactory::PATTERN_HEADER, "pattern header")) break;
+
+			const auto sidesAt = reader.getOffset();
+			auto sides = reader.read32(0, 256, "pattern sides");
+			if (sides < PatternFactory::MIN_PATTERN_SIDES) {
+				reader.report("pattern sides", "is below the minimum, raised to 3", sidesAt);
+				sides = PatternFactory::MIN_PATTERN_SIDES;
+			}
+
+			const auto walls = reader.read32(1, 1000, "pattern walls");
+			report.walls += walls;
+			for (auto w = 0; w < walls && reader.isOk(); w++) {
+				const auto wallAt = reader.getOffset();
+				reader.read16("wall distance");
+				const auto height = static_cast<uint16_t>(reader.read16("wall height"));
+				const auto side = static_cast<uint16_t>(reader.read16("wall side"));
+				if (height < WallFactory::MIN_WALL_HEIGHT) reader.report("wall height", "is below the minimum, raised to 4", wallAt + 2);
+				if (side >= sides) reader.report("wall side", "is past the pattern's last side, moved onto it", wallAt + 4);
+			}
+
+			reader.compare(PatternFactory::PATTERN_FOOTER, "pattern footer");
+		}
+
+		if (!reader.isOk()) return done();
+
+		report.levels = reader.read32(1, 300, "number of levels");
+		for (auto l = 0; l < report.levels && reader.isOk(); l++) {
+			if (!reader.compare(LevelFactory::LEVEL_HEADER, "level header")) break;
+			reader.readView("level name");
+			reader.readView("level difficulty");
+			reader.readView("level mode");
+			reader.readView("level creator");
+			reader.readView("level music");
+			checkColors(reader, "level background 1", "level background 1 color");
+			checkColors(reader, "level background 2", "level background 2 color");
+			checkColors(reader, "level foreground", "level foreground color");
+			checkFloat(reader, "level wall speed");
+			checkFloat(reader, "level rotation speed");
+			checkFloat(reader, "level cursor speed");
+			reader.read32(4, 8192, "level pulse");
+
+			const auto nextAt = reader.getOffset();
+			const auto next = reader.read32(-1, 8192, "next index");
+			if (next >= report.levels) reader.report("next index", "links past the last level in the pack", nextAt);
+			checkFloat(reader, "next time");
+
+			const auto count = reader.read32(1, 512, "level pattern count");
+			for (auto i = 0; i < count && reader.isOk(); i++) {
+				const auto searchAt = reader.getOffset();
+				const auto search = reader.readString("level pattern name match");
+				if (!names.count(search)) reader.report("level pattern name match", ("\"" + search + "\" is not a pattern in this pack").c_str(), searchAt);
+			}
+
+			reader.compare(LevelFactory::LEVEL_FOOTER, "level footer");
+		}
+
+		if (!reader.compare(Load::PROJECT_FOOTER, "file footer")) return done();
+		if (reader.getOffset() != reader.getSize()) reader.report("file", "has extra bytes after the footer", reader.getOffset());
+		return done();
+	}
+}
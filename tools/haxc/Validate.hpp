@@ -0,0 +1,25 @@
+#ifndef SUPER_HAXAGON_VALIDATE_HPP
+#define SUPER_HAXAGON_VALIDATE_HPP
+
+#include <cstddef>
+
+namespace SuperHaxagon {
+	class Reader;
+
+	struct PackReport {
+		size_t problems;
+		int patterns;
+		int levels;
+		int walls;
+	};
+
+	/**
+	 * Walks a HAX1.1 pack with the same limits the game uses, but reports
+	 * everything the game would quietly fix instead of stopping at the first
+	 * thing: clamped counts, walls past the last side, missing patterns, and so
+	 * on. Only a broken structure (a bad tag, running off the end) stops it.
+	 */
+	PackReport validatePack(Reader& reader);
+}
+
+#endif //SUPER_HAXAGON_VALIDATE_HPP
@@ -0,0 +1,108 @@
+#include "Generator.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+namespace SuperHaxagon {
+	static constexpr int ROW_SPACING = 32;
+	static constexpr int ROW_HEIGHT = 16;
+	static constexpr uint32_t SHARED_SEED = 0x5EED;
+
+	static void writeLE(std::ostream& out, const uint32_t value, const int bytes) {
+		for (auto i = 0; i < bytes; i++) out.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+	}
+
+	static void write32(std::ostream& out, const int32_t value) {
+		writeLE(out, static_cast<uint32_t>(value), 4);
+	}
+
+	static void write16(std::ostream& out, const int16_t value) {
+		writeLE(out, static_cast<uint16_t>(value), 2);
+	}
+
+	static void writeFloat(std::ostream& out, const float value) {
+		uint32_t bits;
+		std::copy_n(reinterpret_cast<const char*>(&value), sizeof(bits), reinterpret_cast<char*>(&bits));
+		writeLE(out, bits, 4);
+	}
+
+	static void writeText(std::ostream& out, const std::string& str) {
+		write32(out, static_cast<int32_t>(str.size()));
+		out.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+
+	static void writeColors(std::ostream& out, std::mt19937& rng, const int count) {
+		write32(out, count);
+		for (auto i = 0; i < count; i++) {
+			for (auto channel = 0; channel < 3; channel++) out.put(static_cast<char>(rng() & 0xFF));
+		}
+	}
+
+	void generatePack(std::ostream& out, const GeneratorOptions& options) {
+		std::mt19937 rng(options.seed);
+		std::mt19937 common(SHARED_SEED);
+		const auto patterns = std::clamp(options.patterns, 1, GeneratorOptions::MAX_STREAMED_PATTERNS);
+		const auto walls = std::clamp(options.walls, 1, GeneratorOptions::MAX_WALLS);
+		const auto sides = std::clamp(options.sides, 3, GeneratorOptions::MAX_SIDES);
+		const auto colors = std::clamp(options.colors, 1, GeneratorOptions::MAX_COLORS);
+		const auto levels = std::clamp(options.levels, 1, GeneratorOptions::MAX_LEVELS);
+
+		out.write("HAX1.1", 6);
+		write32(out, patterns);
+		for (auto p = 0; p < patterns; p++) {
+			auto& source = p < options.shared ? common : rng;
+			writeText(out, "GEN" + std::to_string(p));
+			out.write("PTN1.1", 6);
+			write32(out, sides);
+			write32(out, walls);
+
+			// Fill each row but one side, then move out to the next row
+			auto gap = static_cast<int>(source() % sides);
+			auto side = 0;
+			auto row = 0;
+			for (auto w = 0; w < walls; w++) {
+				if (side == gap) side++;
+				if (side >= sides) {
+					side = 0;
+					row++;
+					gap = static_cast<int>(source() % sides);
+					if (side == gap) side++;
+				}
+
+				write16(out, static_cast<int16_t>(std::min(row * ROW_SPACING, 0x7FFF)));
+				write16(out, ROW_HEIGHT);
+				write16(out, static_cast<int16_t>(side++));
+			}
+
+			out.write("ENDPTN", 6);
+		}
+
+		write32(out, levels);
+		for (auto l = 0; l < levels; l++) {
+			out.write("LEV3.0", 6);
+			writeText(out, "GENERATED " + std::to_string(l));
+			writeText(out, "SYNTHETIC");
+			writeText(out, "NORMAL");
+			writeText(out, "HAXGEN");
+			writeText(out, "NONE");
+			writeColors(out, rng, colors);
+			writeColors(out, rng, colors);
+			writeColors(out, rng, colors);
+			writeFloat(out, 2.0f);
+			writeFloat(out, 0.04f);
+			writeFloat(out, 0.08f);
+			write32(out, 60);
+			write32(out, -1);
+			writeFloat(out, 0.0f);
+
+			// Levels can only reference so many patterns
+			const auto count = std::min(patterns, GeneratorOptions::MAX_LEVEL_PATTERNS);
+			write32(out, count);
+			for (auto p = 0; p < count; p++) writeText(out, "GEN" + std::to_string(p));
+			out.write("ENDLEV", 6);
+		}
+
+		out.write("ENDHAX", 6);
+	}
+}
@@ -0,0 +1,40 @@
+#ifndef SUPER_HAXAGON_GENERATOR_HPP
+#define SUPER_HAXAGON_GENERATOR_HPP
+
+#include <cstdint>
+#include <ostream>
+
+namespace SuperHaxagon {
+	/**
+	 * Shape of a synthetic HAX1.1 pack. The defaults match the upper limits
+	 * of what the game's parser accepts, clamp your own values to them.
+	 */
+	struct GeneratorOptions {
+		static constexpr int MAX_PATTERNS = 300;
+		static constexpr int MAX_STREAMED_PATTERNS = 4096; // Packs only the streaming loader takes
+		static constexpr int MAX_WALLS = 1000;
+		static constexpr int MAX_SIDES = 256;
+		static constexpr int MAX_COLORS = 512;
+		static constexpr int MAX_LEVELS = 300;
+		static constexpr int MAX_LEVEL_PATTERNS = 512;
+
+		int patterns = 10;
+		int walls = 16;
+		int sides = 6;
+		int colors = 4;
+		int levels = 1;
+		uint32_t seed = 1;
+
+		// The first patterns come out the same whatever the seed,
+		// like packs that ship copies of each other's patterns
+		int shared = 0;
+	};
+
+	/**
+	 * Writes a valid, little endian HAX1.1 pack. Walls are laid out in rows with
+	 * one open side each, so the patterns are also (barely) playable.
+	 */
+	void generatePack(std::ostream& out, const GeneratorOptions& options);
+}
+
+#endif //SUPER_HAXAGON_GENERATOR_HPP
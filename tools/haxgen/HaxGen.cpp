@@ -0,0 +1,65 @@
+#include "Generator.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace SuperHaxagon;
+
+static void usage() {
+	std::cerr << "usage: haxgen [options] <output.haxagon>\n"
+	             "  --patterns=n  patterns in the pack (1-4096, over 300 is only loaded streamed, default 10)\n"
+	             "  --walls=n     walls per pattern (1-1000, default 16)\n"
+	             "  --sides=n     sides per pattern (3-256, default 6)\n"
+	             "  --colors=n    colours per list (1-512, default 4)\n"
+	             "  --levels=n    levels in the pack (1-300, default 1)\n"
+	             "  --seed=n      random seed (default 1)\n"
+	             "  --shared=n    patterns that are the same for every seed (default 0)\n";
+}
+
+static bool option(const std::string& arg, const std::string& name, int& value) {
+	if (arg.compare(0, name.size(), name) != 0) return false;
+	value = std::atoi(arg.c_str() + name.size());
+	return true;
+}
+
+int main(const int argc, char** argv) {
+	GeneratorOptions options;
+	std::string output;
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		auto seed = 0;
+		if (option(arg, "--patterns=", options.patterns)) continue;
+		if (option(arg, "--walls=", options.walls)) continue;
+		if (option(arg, "--sides=", options.sides)) continue;
+		if (option(arg, "--colors=", options.colors)) continue;
+		if (option(arg, "--levels=", options.levels)) continue;
+		if (option(arg, "--shared=", options.shared)) continue;
+		if (option(arg, "--seed=", seed)) {
+			options.seed = static_cast<uint32_t>(seed);
+			continue;
+		}
+
+		if (arg.compare(0, 2, "--") == 0 || !output.empty()) {
+			usage();
+			return 2;
+		}
+
+		output = arg;
+	}
+
+	if (output.empty()) {
+		usage();
+		return 2;
+	}
+
+	std::ofstream file(output, std::ios::out | std::ios::binary);
+	generatePack(file, options);
+	if (!file) {
+		std::cerr << "cannot write " << output << std::endl;
+		return 1;
+	}
+
+	return 0;
+}